@@ -0,0 +1,190 @@
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include "imgui.h"
+
+#include "allocationTracker.h"
+
+namespace {
+    struct ZoneSlot {
+        const char* name{nullptr};
+        std::atomic<std::uint64_t> current{0};
+        std::uint64_t lastFrame{0};
+    };
+
+    /// Deepest nesting of the zones, deeper ones are charged to their parent
+    constexpr std::size_t maxZoneDepth{8};
+
+    std::atomic<std::uint64_t> frameAllocations{0};
+    std::atomic<std::uint64_t> totalAllocations{0};
+    std::uint64_t lastFrameAllocations{0};
+
+    std::array<ZoneSlot, AllocationTracker::maxNbZones> zones{};
+    std::size_t nbZones{0};
+    std::atomic<int> currentZone{-1};
+
+    // Only the main thread opens zones
+    std::array<int, maxZoneDepth> zoneStack{};
+    std::size_t zoneDepth{0};
+    std::size_t nbIgnoredZones{0};
+
+    void countAllocation() {
+        frameAllocations.fetch_add(1, std::memory_order_relaxed);
+        totalAllocations.fetch_add(1, std::memory_order_relaxed);
+
+        const int zone{currentZone.load(std::memory_order_relaxed)};
+
+        if (zone >= 0) {
+            zones[zone].current.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    void* allocate(std::size_t size) {
+        countAllocation();
+        return std::malloc(size == 0 ? 1 : size);
+    }
+
+    void* allocateAligned(std::size_t size, std::align_val_t alignment) {
+        countAllocation();
+
+        // aligned_alloc wants a size multiple of the alignment
+        const std::size_t align{static_cast<std::size_t>(alignment)};
+        return std::aligned_alloc(align, (size + align - 1) / align * align);
+    }
+
+    void* allocateImGui(std::size_t size, void*) {
+        countAllocation();
+        return std::malloc(size);
+    }
+
+    void freeImGui(void* pointer, void*) {
+        std::free(pointer);
+    }
+}
+
+void AllocationTracker::beginFrame() {
+    lastFrameAllocations = frameAllocations.exchange(0, std::memory_order_relaxed);
+
+    for (std::size_t i = 0; i < nbZones; ++i) {
+        zones[i].lastFrame = zones[i].current.exchange(0, std::memory_order_relaxed);
+    }
+}
+
+std::uint64_t AllocationTracker::getLastFrameAllocations() {
+    return lastFrameAllocations;
+}
+
+std::uint64_t AllocationTracker::getTotalAllocations() {
+    return totalAllocations.load(std::memory_order_relaxed);
+}
+
+std::size_t AllocationTracker::getNbZones() {
+    return nbZones;
+}
+
+AllocationTracker::ZoneCount AllocationTracker::getZone(std::size_t index) {
+    return ZoneCount{zones[index].name, zones[index].lastFrame};
+}
+
+void AllocationTracker::installImGuiAllocator() {
+    ImGui::SetAllocatorFunctions(allocateImGui, freeImGui, nullptr);
+}
+
+void AllocationTracker::enterZone(const char* name) {
+    if (zoneDepth == maxZoneDepth) {
+        ++nbIgnoredZones;
+        return;
+    }
+
+    int zone{-1};
+
+    for (std::size_t i = 0; i < nbZones; ++i) {
+        if (zones[i].name == name) {
+            zone = static_cast<int>(i);
+        }
+    }
+
+    if (zone < 0 && nbZones < maxNbZones) {
+        zones[nbZones].name = name;
+        zone = static_cast<int>(nbZones);
+        ++nbZones;
+    }
+
+    // Past maxNbZones a new zone stays charged to its parent
+    if (zone < 0) {
+        zone = currentZone.load(std::memory_order_relaxed);
+    }
+
+    zoneStack[zoneDepth] = zone;
+    ++zoneDepth;
+    currentZone.store(zone, std::memory_order_relaxed);
+}
+
+void AllocationTracker::leaveZone() {
+    if (nbIgnoredZones > 0) {
+        --nbIgnoredZones;
+        return;
+    }
+
+    --zoneDepth;
+    currentZone.store(zoneDepth == 0 ? -1 : zoneStack[zoneDepth - 1], std::memory_order_relaxed);
+}
+
+// Replacements of the global allocation functions, the deallocation ones have to match
+void* operator new(std::size_t size) {
+    void* pointer{allocate(size)};
+
+    if (!pointer) {
+        throw std::bad_alloc();
+    }
+
+    return pointer;
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return allocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return allocate(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    void* pointer{allocateAligned(size, alignment)};
+
+    if (!pointer) {
+        throw std::bad_alloc();
+    }
+
+    return pointer;
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return operator new(size, alignment);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return allocateAligned(size, alignment);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return allocateAligned(size, alignment);
+}
+
+void operator delete(void* pointer) noexcept {std::free(pointer);}
+void operator delete[](void* pointer) noexcept {std::free(pointer);}
+void operator delete(void* pointer, std::size_t) noexcept {std::free(pointer);}
+void operator delete[](void* pointer, std::size_t) noexcept {std::free(pointer);}
+void operator delete(void* pointer, const std::nothrow_t&) noexcept {std::free(pointer);}
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept {std::free(pointer);}
+void operator delete(void* pointer, std::align_val_t) noexcept {std::free(pointer);}
+void operator delete[](void* pointer, std::align_val_t) noexcept {std::free(pointer);}
+void operator delete(void* pointer, std::size_t, std::align_val_t) noexcept {std::free(pointer);}
+void operator delete[](void* pointer, std::size_t, std::align_val_t) noexcept {std::free(pointer);}
+void operator delete(void* pointer, std::align_val_t, const std::nothrow_t&) noexcept {std::free(pointer);}
+void operator delete[](void* pointer, std::align_val_t, const std::nothrow_t&) noexcept {std::free(pointer);}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Counts of the global heap allocations, per frame and per zone of the frame loop
+ * @details Built with GRAVITY_TRACK_ALLOCATIONS, allocationTracker.cpp then replaces the global
+ *          operator new and delete and the ImGui allocator with counting ones. Without it every
+ *          function below is a no-op and the counts stay at zero.
+ *          Zones are named scopes of the frame loop (see Zone), the allocations of a frame are
+ *          charged to the innermost open zone. The counts are per process and the zones are meant
+ *          for the main thread: the worker threads' allocations are counted in the open zone too.
+ * @author Axel LT
+ * @since 2026-10-19
+ */
+namespace AllocationTracker {
+#ifdef GRAVITY_TRACK_ALLOCATIONS
+    inline constexpr bool enabled{true};
+#else
+    inline constexpr bool enabled{false};
+#endif
+
+    inline constexpr std::size_t maxNbZones{16};
+
+    struct ZoneCount {
+        const char* name;
+        std::uint64_t lastFrame;
+    };
+
+#ifdef GRAVITY_TRACK_ALLOCATIONS
+    /**
+     * @brief Close the current frame and start counting the next one
+     */
+    void beginFrame();
+
+    /// Allocations made during the last closed frame
+    std::uint64_t getLastFrameAllocations();
+
+    /// Allocations since the start of the process
+    std::uint64_t getTotalAllocations();
+
+    std::size_t getNbZones();
+
+    /**
+     * @brief Get the count of a zone during the last closed frame
+     * @param index Zone index, lower than getNbZones()
+     */
+    ZoneCount getZone(std::size_t index);
+
+    /**
+     * @brief Route the ImGui allocations through the counter, before ImGui::CreateContext
+     */
+    void installImGuiAllocator();
+
+    void enterZone(const char* name);
+    void leaveZone();
+#else
+    inline void beginFrame() {}
+    inline std::uint64_t getLastFrameAllocations() {return 0;}
+    inline std::uint64_t getTotalAllocations() {return 0;}
+    inline std::size_t getNbZones() {return 0;}
+    inline ZoneCount getZone(std::size_t) {return ZoneCount{"", 0};}
+    inline void installImGuiAllocator() {}
+    inline void enterZone(const char*) {}
+    inline void leaveZone() {}
+#endif
+
+    /**
+     * @class Zone
+     * @brief Charges the allocations of a scope to a named zone
+     * @details The name must outlive the program (a string literal), zones are told apart by their pointer.
+     */
+    class Zone {
+    public:
+        explicit Zone(const char* name) {enterZone(name);}
+        ~Zone() {leaveZone();}
+
+        Zone(const Zone&) = delete;
+        Zone& operator=(const Zone&) = delete;
+    };
+}
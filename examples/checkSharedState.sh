@@ -0,0 +1,37 @@
+#!/bin/sh
+# Scripted check of the shared-state export: a windowless producer publishes while
+# GravityStateReader attaches, the script fails if a snapshot is torn or inconsistent
+# Usage: examples/checkSharedState.sh [build directory] [number of snapshots]
+
+buildDirectory=${1:-build}
+nbSnapshots=${2:-20}
+segment=/dev/shm/gravity_state
+
+rm -f "$segment"
+
+"$buildDirectory/Gravity" --export 1000 &
+producer=$!
+trap 'kill "$producer" 2>/dev/null; rm -f "$segment"' EXIT
+
+# The producer creates the segment once its particles are spawned
+tries=0
+
+while [ ! -e "$segment" ]; do
+    if ! kill -0 "$producer" 2>/dev/null || [ "$tries" -ge 100 ]; then
+        echo "The producer did not create $segment" >&2
+        exit 1
+    fi
+
+    tries=$((tries + 1))
+    sleep 0.1
+done
+
+# Let the header be written and a few steps be published
+sleep 0.5
+
+if ! "$buildDirectory/GravityStateReader" /gravity_state "$nbSnapshots"; then
+    echo "Shared-state check failed" >&2
+    exit 1
+fi
+
+echo "Shared-state check passed"
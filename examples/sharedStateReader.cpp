@@ -0,0 +1,236 @@
+// Minimal consumer of the live state exported by the simulation (see SharedState)
+// Usage: GravityStateReader [segment name] [number of snapshots]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "sharedState.h"
+
+struct Snapshot {
+    std::uint64_t step{0};
+    std::uint32_t nbParticles{0};
+    std::vector<float> fields[SharedState::nbFields];
+};
+
+// Copy the segment without blocking the writer, retry while a step is being published
+static int readSnapshot(const SharedState::Header* header, Snapshot& snapshot) {
+    int retries{0};
+
+    while (true) {
+        const std::uint64_t before{header->sequence.load(std::memory_order_acquire)};
+
+        if (before % 2 == 0) {
+            snapshot.step = header->step.load(std::memory_order_relaxed);
+            snapshot.nbParticles = std::min(header->nbParticles.load(std::memory_order_relaxed), header->capacity);
+
+            for (std::uint32_t field = 0; field < SharedState::nbFields; ++field) {
+                const float* source{SharedState::array(header, static_cast<SharedState::Field>(field))};
+                snapshot.fields[field].assign(source, source + snapshot.nbParticles);
+            }
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            if (header->sequence.load(std::memory_order_relaxed) == before) {
+                return retries;
+            }
+        }
+
+        ++retries;
+        std::this_thread::yield();
+    }
+}
+
+struct Segment {
+    const SharedState::Header* header{nullptr};
+    std::size_t size{0};
+};
+
+// Map a segment read-only and check that its header describes arrays inside the mapping
+static bool attach(const char* name, Segment& segment, bool quiet) {
+    int fd{shm_open(name, O_RDONLY, 0)};
+
+    if (fd == -1) {
+        if (!quiet) {
+            std::cerr << "Opening " << name << " failed: " << std::strerror(errno) << '\n';
+        }
+        return false;
+    }
+
+    struct stat info;
+
+    if (fstat(fd, &info) == -1) {
+        std::cerr << "Reading the size of " << name << " failed: " << std::strerror(errno) << '\n';
+        close(fd);
+        return false;
+    }
+
+    // A stale or foreign segment may be too small to even hold the header
+    const std::size_t segmentSize{static_cast<std::size_t>(std::max<off_t>(info.st_size, 0))};
+
+    if (segmentSize < SharedState::headerSize()) {
+        if (!quiet) {
+            std::cerr << name << " is too small for a Gravity state segment (" << segmentSize << " bytes)\n";
+        }
+        close(fd);
+        return false;
+    }
+
+    void* address{mmap(nullptr, segmentSize, PROT_READ, MAP_SHARED, fd, 0)};
+    close(fd);
+
+    if (address == MAP_FAILED) {
+        std::cerr << "Mapping " << name << " failed: " << std::strerror(errno) << '\n';
+        return false;
+    }
+
+    const auto* header{static_cast<const SharedState::Header*>(address)};
+
+    if (header->magic != SharedState::magic || header->layoutVersion != SharedState::layoutVersion) {
+        if (!quiet) {
+            std::cerr << name << " is not a Gravity state segment of layout version " << SharedState::layoutVersion << '\n';
+        }
+        munmap(address, segmentSize);
+        return false;
+    }
+
+    // The arrays are read at offsets computed from the header, they must all be inside the mapping
+    if (header->headerSize < sizeof(SharedState::Header) ||
+        segmentSize < header->headerSize + SharedState::nbFields * SharedState::arraySize(header->capacity)) {
+        std::cerr << name << " (" << segmentSize << " bytes) can't hold the " << header->capacity << " particles of its header\n";
+        munmap(address, segmentSize);
+        return false;
+    }
+
+    segment.header = header;
+    segment.size = segmentSize;
+    return true;
+}
+
+// The writer retired the segment for a larger one: it is unlinked then created again, so retry for a while
+static bool reattach(const char* name, Segment& segment) {
+    munmap(const_cast<SharedState::Header*>(segment.header), segment.size);
+    segment = Segment{};
+
+    for (int tries = 0; tries < 40; ++tries) {
+        if (attach(name, segment, true) && !segment.header->retired.load(std::memory_order_acquire)) {
+            return true;
+        }
+
+        if (segment.header) {
+            munmap(const_cast<SharedState::Header*>(segment.header), segment.size);
+            segment = Segment{};
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+
+    return attach(name, segment, false);
+}
+
+int main(int argc, char* argv[]) {
+    const char* name{argc > 1 ? argv[1] : SharedState::defaultName};
+    const int nbSnapshots{argc > 2 ? std::atoi(argv[2]) : 10};
+
+    Segment segment;
+
+    if (!attach(name, segment, false)) {
+        return -1;
+    }
+
+    Snapshot snapshot;
+    Snapshot reread;
+    std::uint64_t lastStep{0};
+    int nbRereads{0};
+    int result{0};
+
+    for (int i = 0; i < nbSnapshots; ++i) {
+        // The population outgrew the segment, the writer moved to a larger one
+        if (segment.header->retired.load(std::memory_order_acquire)) {
+            if (!reattach(name, segment)) {
+                return -1;
+            }
+
+            std::cout << "segment retired, attached again (room for " << segment.header->capacity << " particles)\n";
+        }
+
+        const int retries{readSnapshot(segment.header, snapshot)};
+
+        // Read again right away: while the step is the same, a consistent copy is bit for bit the same
+        readSnapshot(segment.header, reread);
+
+        // The step goes back when the producer loads a checkpoint or rewinds: a new epoch, not an error
+        const bool newEpoch{snapshot.step < lastStep || reread.step < snapshot.step};
+        const bool sameStep{reread.step == snapshot.step};
+        bool consistent{true};
+
+        if (sameStep) {
+            ++nbRereads;
+            consistent = consistent && reread.nbParticles == snapshot.nbParticles;
+
+            for (std::uint32_t field = 0; field < SharedState::nbFields; ++field) {
+                consistent = consistent && reread.fields[field] == snapshot.fields[field];
+            }
+        }
+
+        // Only real particles: finite values and a positive diameter
+        double momentumX{0.0}, momentumY{0.0};
+
+        for (std::uint32_t p = 0; p < snapshot.nbParticles; ++p) {
+            const float diameter{snapshot.fields[SharedState::diameter][p]};
+            consistent = consistent && diameter > 0.0f;
+
+            for (std::uint32_t field = 0; field < SharedState::nbFields; ++field) {
+                consistent = consistent && std::isfinite(snapshot.fields[field][p]);
+            }
+
+            // Mass grows with the square of the diameter (see Particle)
+            momentumX += diameter * diameter * snapshot.fields[SharedState::velocityX][p];
+            momentumY += diameter * diameter * snapshot.fields[SharedState::velocityY][p];
+        }
+
+        // Same step, same particles: the momentum of the re-read copy can't differ at all
+        if (sameStep) {
+            double rereadMomentumX{0.0}, rereadMomentumY{0.0};
+
+            for (std::uint32_t p = 0; p < reread.nbParticles; ++p) {
+                const float diameter{reread.fields[SharedState::diameter][p]};
+                rereadMomentumX += diameter * diameter * reread.fields[SharedState::velocityX][p];
+                rereadMomentumY += diameter * diameter * reread.fields[SharedState::velocityY][p];
+            }
+
+            consistent = consistent && rereadMomentumX == momentumX && rereadMomentumY == momentumY;
+        }
+
+        std::cout << "step " << snapshot.step << " | " << snapshot.nbParticles << " particles | "
+                  << retries << " retries | momentum ~ (" << momentumX << ", " << momentumY << ")"
+                  << (sameStep ? " | re-read identical" : "")
+                  << (newEpoch ? " | new epoch" : "")
+                  << (consistent ? "" : " | INCONSISTENT") << '\n';
+
+        if (!consistent) {
+            result = -1;
+        }
+
+        lastStep = reread.step;
+        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    }
+
+    std::cout << nbRereads << " of " << nbSnapshots << " snapshots compared with a re-read of the same step\n";
+
+    munmap(const_cast<SharedState::Header*>(segment.header), segment.size);
+
+    return result;
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief State of a file pushed to AsyncFileWriter
+ */
+enum class WriteStatus {
+    pending, ///< Queued or being written
+    written, ///< Complete on disk
+    failed   ///< The stream failed, the file may be missing or truncated
+};
+
+/**
+ * @class AsyncFileWriter
+ * @brief Writes files on a background thread so that the simulation never waits for the disk
+ * @details Buffers are recycled: take one with acquireBuffer(), fill it and give it back with push().
+ *          Once written the buffer returns to the free list, so a steady stream of files stops allocating.
+ * @note push() blocks when maxPending files are waiting, this is the only backpressure
+ * @author Axel LT
+ * @since 2026-10-19
+ */
+class AsyncFileWriter {
+public:
+    /**
+     * @brief Start the writer thread
+     * @param maxPending Maximum number of files waiting to be written
+     */
+    explicit AsyncFileWriter(std::size_t maxPending = 8);
+
+    /**
+     * @brief Write everything still pending and stop the writer thread
+     */
+    ~AsyncFileWriter();
+
+    AsyncFileWriter(const AsyncFileWriter&) = delete;
+    AsyncFileWriter& operator=(const AsyncFileWriter&) = delete;
+
+    /**
+     * @brief Get an empty buffer, recycled if possible
+     * @return Buffer to fill and give back with push()
+     */
+    std::vector<std::uint8_t> acquireBuffer();
+
+    /**
+     * @brief Queue a file to be written
+     * @param path Path of the file, overwritten if it exists
+     * @param bytes Content of the file
+     * @return Ticket of the file, see getStatus
+     */
+    std::uint64_t push(std::string path, std::vector<std::uint8_t>&& bytes);
+
+    /**
+     * @brief Get the number of files not written yet, queued or being written
+     * @return Number of pending files
+     */
+    std::size_t getNbPending();
+
+    /**
+     * @brief Get where a pushed file is
+     * @details The file is only complete on disk once written: it left the queue before being opened.
+     * @param ticket Ticket returned by push
+     * @return Status of the file
+     */
+    WriteStatus getStatus(std::uint64_t ticket);
+
+    /**
+     * @brief Get the number of files that couldn't be written
+     * @return Number of failed writes since construction
+     */
+    std::size_t getNbFailures();
+
+private:
+    struct PendingFile {
+        std::uint64_t ticket{0};
+        std::string path;
+        std::vector<std::uint8_t> bytes;
+    };
+
+    void writerLoop();
+
+
+    std::thread m_writer;
+
+    std::mutex m_mutex;
+    std::condition_variable m_hasWork;
+    std::condition_variable m_hasRoom;
+
+    std::deque<PendingFile> m_pending;
+    std::vector<std::vector<std::uint8_t>> m_freeBuffers;
+
+    std::size_t m_maxPending;
+    std::size_t m_nbFailures{0};
+
+    /// Files are written in push order: tickets up to m_lastWrittenTicket are done, the failed ones are kept
+    std::uint64_t m_lastTicket{0};
+    std::uint64_t m_lastWrittenTicket{0};
+    std::vector<std::uint64_t> m_failedTickets;
+    bool m_stopping{false};
+};
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "map.h"
+#include "particle.h"
+
+/**
+ * @namespace Checkpoint
+ * @brief Binary snapshots of the particles, to resume a run later
+ * @details A checkpoint is a small header (magic, format version, step, number of particles)
+ *          followed for each particle by its mass, top left corner and velocity.
+ *          Encoding only fills a buffer, the file itself is written by an AsyncFileWriter.
+ * @author Axel LT
+ * @since 2026-10-19
+ */
+namespace Checkpoint {
+    /// Directory where the simulation saves its checkpoints
+    inline constexpr char directory[]{"checkpoints"};
+
+    /**
+     * @brief Encode the particles into a checkpoint
+     * @param particles Particles of the simulation
+     * @param step Simulation step of the particles
+     * @param bytes Buffer receiving the checkpoint, previous content is discarded
+     */
+    void encode(const std::vector<Particle>& particles, std::uint64_t step, std::vector<std::uint8_t>& bytes);
+
+    /**
+     * @brief Load a checkpoint file, the current particles are replaced
+     * @param path Path of the checkpoint
+     * @param map Map the particles are placed on
+     * @param particles Particles of the simulation
+     * @return Simulation step stored in the checkpoint
+     */
+    std::uint64_t load(const char* path, const Map& map, std::vector<Particle>& particles);
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "map.h"
+#include "obstacleField.h"
+#include "particle.h"
+#include "sparseGrid.h"
+
+/**
+ * @class ContinuousCollision
+ * @brief Swept collision detection for the fast particles of the time-stepped engine
+ * @details Particle::move moves first and tests overlaps afterwards, so a particle moving more
+ *          than a radius per step can tunnel through another particle or a wall.
+ *          For the particles faster than the speed threshold:
+ *          - broad phase: sort and sweep of the swept AABBs (box covering the start and end discs)
+ *            of the fast particles only, the slow particles near each fast box are found
+ *            through a grid of their centers, so nothing is sorted but the fast set,
+ *          - narrow phase: exact time of impact of the discs moving linearly, and of the walls,
+ *          - each particle is advanced to its first impact, the collision is solved,
+ *            then it moves for the rest of the step.
+ *          Every move is traced through the obstacle distance field (Particle::moveAgainstObstacles),
+ *          the pair impact times assume straight paths so a particle deflected by an obstacle
+ *          before its pair impact meets the other particle in the overlap solver instead.
+ *          The remaining particles are moved as usual by the engine.
+ * @author Axel LT
+ * @since 2026-10-19
+ */
+class ContinuousCollision {
+public:
+    float getSpeedThreshold() const {return m_speedThreshold;}
+    void setSpeedThreshold(float speedThreshold) {m_speedThreshold = speedThreshold;}
+
+    /// Coefficient of restitution of the pair impacts, see Particle::solveContactCollision
+    float getRestitution() const {return m_restitution;}
+    void setRestitution(float restitution) {m_restitution = restitution;}
+
+    /**
+     * @brief Advance the fast particles (and the particles they hit) to the end of the step
+     * @param particles Particles of the simulation
+     * @param map Reference to the map
+     * @param obstacles Distance field of the solid squares of the map
+     * @param deltaTime Time elapsed since last frame
+     */
+    void advance(std::vector<Particle>& particles, const Map& map, const ObstacleField& obstacles, const float deltaTime);
+
+    /**
+     * @brief Check if a particle has already been moved by the last advance()
+     * @param i Particle index
+     * @return True if the engine must not move it again
+     */
+    bool isAdvanced(std::size_t i) const {return m_advanced[i] != 0;}
+
+    /// Statistics shown in the ImGui window
+    std::size_t getNbFastParticles() const {return m_nbFastParticles;}
+    std::size_t getNbImpacts() const {return m_nbImpacts;}
+
+private:
+    struct SweptBox {
+        float minX;
+        float maxX;
+        float minY;
+        float maxY;
+        std::uint32_t index;
+    };
+
+    struct Impact {
+        float time;
+        std::uint32_t particle;
+        std::uint32_t otherParticle; ///< noParticle for a wall
+        std::uint8_t axis;           ///< Wall axis, 0 for x and 1 for y
+    };
+
+    static constexpr std::uint32_t noParticle{0xFFFFFFFFu};
+
+    static SweptBox sweptBox(const Particle& particle, std::uint32_t index, const float deltaTime);
+    static float pairTimeOfImpact(const Particle& particle, const Particle& otherParticle, const float deltaTime);
+    void moveParticle(Particle& particle, const Map& map, const ObstacleField& obstacles, const float time) const;
+    void addPairImpact(const std::vector<Particle>& particles, std::uint32_t index, std::uint32_t otherIndex, const float deltaTime);
+    void addWallImpacts(const Particle& particle, std::uint32_t index, const Map& map, const float deltaTime);
+
+
+    float m_speedThreshold{3000.0f};
+    float m_restitution{1.0f};
+
+    /// Scratch buffers kept between steps
+    std::vector<std::uint8_t> m_fast;
+    std::vector<std::uint8_t> m_advanced;
+    std::vector<SweptBox> m_boxes;
+    SparseGrid m_grid;
+    std::vector<std::uint32_t> m_active;
+    std::vector<Impact> m_impacts;
+
+    std::size_t m_nbFastParticles{0};
+    std::size_t m_nbImpacts{0};
+};
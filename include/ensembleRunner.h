@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "simulation.h"
+
+/**
+ * @class EnsembleRunner
+ * @brief Runs a parameter sweep of independent headless simulations on all the cores
+ * @details The sweep spec is a text file of "key = value, value, ..." lines ('#' starts a comment):
+ *          - particles, minMass, maxMass, maxSpeed, restitution: swept values, every combination is run
+ *          - repeats: runs per combination, each with its own seed (seed + run index)
+ *          - steps, deltaTime, seed: shared by all the runs
+ *          Each worker thread is pinned to a core and takes the next run when it is done with the
+ *          previous one, the instance is built, run and destroyed on that thread with a single thread
+ *          of its own. All the allocations of an instance therefore go through the malloc arena of its
+ *          worker, instances never contend on the allocator and their memory stays local to their core.
+ *          One CSV row is written and flushed per finished run, in completion order.
+ * @author Axel LT
+ * @since 2026-10-19
+ */
+class EnsembleRunner {
+public:
+    /**
+     * @brief Read the sweep spec and expand it into runs
+     * @param specPath Path of the sweep spec
+     */
+    explicit EnsembleRunner(const char* specPath);
+
+    /**
+     * @brief Run every simulation of the sweep
+     * @param outputPath Path of the CSV file receiving one summary row per run
+     * @param nbWorkers Number of worker threads, 0 for one per core
+     */
+    void run(const char* outputPath, unsigned nbWorkers = 0);
+
+    std::size_t getNbRuns() const {return m_runs.size();}
+
+private:
+    void parseSpec(const char* specPath);
+    void workerLoop(unsigned workerIndex);
+    void writeRow(std::size_t runIndex, const Simulation* simulation, double runMs, const std::string& error);
+
+
+    std::vector<SimulationSettings> m_runs;
+    int m_nbSteps{1000};
+    float m_deltaTime{1.0f / 120.0f};
+
+    /// Next run to hand out, protected by m_mutex together with the output
+    std::size_t m_nextRun{0};
+    std::mutex m_mutex;
+    std::ofstream m_output;
+};
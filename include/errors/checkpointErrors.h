@@ -0,0 +1,10 @@
+#pragma once
+
+#include <string>
+#include "simulationErrors.h"
+
+class CheckpointError : public SimulationError {
+public:
+    CheckpointError(const std::string& descriptor) : SimulationError(descriptor) {}
+    CheckpointError(const std::string& descriptor, const std::string& message) : SimulationError(descriptor, message) {}
+};
@@ -0,0 +1,10 @@
+#pragma once
+
+#include <string>
+#include "simulationErrors.h"
+
+class EnsembleError : public SimulationError {
+public:
+    EnsembleError(const std::string& descriptor) : SimulationError(descriptor) {}
+    EnsembleError(const std::string& descriptor, const std::string& message) : SimulationError(descriptor, message) {}
+};
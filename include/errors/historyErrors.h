@@ -0,0 +1,10 @@
+#pragma once
+
+#include <string>
+#include "simulationErrors.h"
+
+class HistoryError : public SimulationError {
+public:
+    HistoryError(const std::string& descriptor) : SimulationError(descriptor) {}
+    HistoryError(const std::string& descriptor, const std::string& message) : SimulationError(descriptor, message) {}
+};
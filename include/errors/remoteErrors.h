@@ -0,0 +1,10 @@
+#pragma once
+
+#include <string>
+#include "simulationErrors.h"
+
+class RemoteError : public SimulationError {
+public:
+    RemoteError(const std::string& descriptor) : SimulationError(descriptor) {}
+    RemoteError(const std::string& descriptor, const std::string& message) : SimulationError(descriptor, message) {}
+};
@@ -0,0 +1,10 @@
+#pragma once
+
+#include <string>
+#include "simulationErrors.h"
+
+class SharedStateError : public SimulationError {
+public:
+    SharedStateError(const std::string& descriptor) : SimulationError(descriptor) {}
+    SharedStateError(const std::string& descriptor, const std::string& message) : SimulationError(descriptor, message) {}
+};
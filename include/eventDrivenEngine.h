@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "Eigen/Dense"
+
+#include "indexedMinHeap.h"
+#include "map.h"
+#include "particle.h"
+#include "observables.h"
+
+/**
+ * @class EventDrivenEngine
+ * @brief Event-driven molecular dynamics for perfectly elastic hard discs with reflecting walls
+ * @details Instead of moving every particle by deltaTime and fixing the overlaps afterwards,
+ *          the engine predicts the exact time of the next wall collision, pair collision and
+ *          cell crossing of each particle and processes them in time order.
+ *          - Each particle keeps only its earliest event in an IndexedMinHeap.
+ *          - Pair predictions only look at the 3x3 surrounding cells of a grid whose cells are
+ *            larger than a particle, cell crossings are events too so the grid stays exact.
+ *          - Events are invalidated lazily: every particle has a collision counter and a pair
+ *            event is dropped when the partner counter changed since the prediction.
+ *          - Particles are only moved when they take part in an event (each keeps its own clock),
+ *            so a step between two renders costs the number of events, not the number of particles.
+ * @note Positions and velocities are kept in double precision between steps, load() again after
+ *       any change made to the particles from the outside
+ * @author Axel LT
+ * @since 2026-10-19
+ */
+class EventDrivenEngine {
+public:
+    /**
+     * @brief Take the particles as initial state and predict all the events
+     * @param particles Particles of the simulation
+     * @param map Map whose borders are the walls
+     */
+    void load(const std::vector<Particle>& particles, const Map& map);
+
+    /**
+     * @brief Process every event up to the current time plus duration
+     * @param duration Time to simulate (s)
+     */
+    void advance(double duration);
+
+    /**
+     * @brief Write the positions and velocities at the current time back into the particles
+     * @param particles Particles given to load(), in the same order
+     * @param map Map given to load()
+     * @param observables Observables accumulated on the way (thread 0)
+     */
+    void store(std::vector<Particle>& particles, const Map& map, Observables& observables) const;
+
+    /// Statistics shown in the ImGui window
+    std::uint64_t getNbPairCollisions() const {return m_nbPairCollisions;}
+    std::uint64_t getNbWallCollisions() const {return m_nbWallCollisions;}
+    std::uint64_t getNbCellCrossings() const {return m_nbCellCrossings;}
+    std::uint64_t getNbInvalidEvents() const {return m_nbInvalidEvents;}
+
+private:
+    enum class EventType : std::uint8_t {
+        none,
+        pair,
+        wall,
+        cellCrossing
+    };
+
+    /// Earliest event of a particle, its time is the key of the particle in m_queue
+    struct Event {
+        EventType type{EventType::none};
+        std::uint8_t axis{0};            ///< Wall or cell crossing: 0 for x, 1 for y
+        std::int8_t direction{0};        ///< Cell crossing: -1 or +1 along axis
+        std::uint32_t partner{0};        ///< Pair: other particle
+        std::uint32_t partnerCount{0};   ///< Pair: collision counter of the partner at prediction time
+    };
+
+    Eigen::Vector2d positionAt(std::uint32_t i, double time) const {return m_positions[i] + m_velocities[i] * (time - m_clocks[i]);}
+    void moveTo(std::uint32_t i, double time);
+
+    void predict(std::uint32_t i);
+    double pairCollisionTime(std::uint32_t i, std::uint32_t j) const;
+
+    void insertInCell(std::uint32_t i, std::uint32_t cell);
+    void removeFromCell(std::uint32_t i);
+
+
+    double m_time{0.0};
+    double m_width{0.0};
+    double m_height{0.0};
+
+    /// Particle state, position m_positions[i] is the center at time m_clocks[i]
+    std::vector<Eigen::Vector2d> m_positions;
+    std::vector<Eigen::Vector2d> m_velocities;
+    std::vector<double> m_clocks;
+    std::vector<double> m_radii;
+    std::vector<double> m_masses;
+    std::vector<std::uint32_t> m_counts;
+
+    std::vector<Event> m_events;
+    IndexedMinHeap m_queue;
+
+    /// Cell grid as intrusive doubly linked lists, so cell crossings don't allocate
+    double m_cellSize{1.0};
+    int m_nbColumns{1};
+    int m_nbRows{1};
+    std::vector<std::uint32_t> m_cellHeads;
+    std::vector<std::uint32_t> m_cells;
+    std::vector<std::uint32_t> m_next;
+    std::vector<std::uint32_t> m_previous;
+    static constexpr std::uint32_t none{0xFFFFFFFFu};
+
+    std::uint64_t m_nbPairCollisions{0};
+    std::uint64_t m_nbWallCollisions{0};
+    std::uint64_t m_nbCellCrossings{0};
+    std::uint64_t m_nbInvalidEvents{0};
+};
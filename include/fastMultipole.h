@@ -0,0 +1,146 @@
+#pragma once
+
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Eigen/Dense"
+
+#include "particle.h"
+#include "threadPool.h"
+
+/**
+ * @brief Error of the fast multipole forces against the exact sum, see FastMultipole::measureError
+ */
+struct MultipoleError {
+    double maxRelativeError{0.0};
+    double rmsRelativeError{0.0};
+    std::size_t nbSamples{0};
+};
+
+/**
+ * @class FastMultipole
+ * @brief 2D fast multipole method for the long-range gravity between all the particles
+ * @details In 2D the gravitational potential of a mass m is G m log|z - z_m| (points as complex numbers),
+ *          so the pull of every particle on every other is computed in O(N) instead of O(N^2):
+ *          - the particles are sorted into an adaptive quadtree, a box is split while it holds more than leafSize particles;
+ *          - upward pass: the complex multipole expansion of order p of each leaf (P2M), shifted into its parents (M2M);
+ *          - downward pass: multipoles of the well-separated boxes converted into local expansions (M2L), shifted
+ *            into the children (L2L) and evaluated at the particles of the leaves (L2P);
+ *          - near field: the pairs of neighbour leaves are summed directly (P2P), with Plummer softening.
+ *          Two boxes are well separated when the sum of their radii is below half the distance between their centers,
+ *          the error then falls by about 2^-p or faster: order 16 keeps the forces within 1e-6 of the exact sum (see measureError).
+ *          The interaction lists come from a traversal of the tree from each box down, so the tree can be
+ *          as unbalanced as the particles are. Every pass runs on the thread pool, a box only writes its own expansions.
+ * @note The softening only applies to the near field, a well-separated pair is further apart than the
+ *       size of its boxes, where it changes the force by less than (softening / distance)^2.
+ * @author Axel LT
+ * @since 2026-10-19
+ */
+class FastMultipole {
+public:
+    explicit FastMultipole(ThreadPool& threadPool) : m_threadPool(threadPool) {}
+
+    /**
+     * @brief Compute the gravitational acceleration of every particle
+     * @param particles Particles, their centers and masses
+     * @param gravitationalConstant G of the 2D potential G m1 m2 log(r) (px^2 / s^2 per unit of mass)
+     */
+    void compute(const std::vector<Particle>& particles, float gravitationalConstant);
+
+    /// Acceleration of each particle at the last compute (px/s^2)
+    const std::vector<Eigen::Vector2f>& getAccelerations() const {return m_accelerations;}
+
+    /// Total potential energy at the last compute, sum over the pairs of G m1 m2 log(r / 1 px) (J)
+    double getPotentialEnergy() const {return m_potentialEnergy;}
+
+    /**
+     * @brief Compare the last computed accelerations with the exact O(N^2) sum
+     * @param particles Same particles as the last compute
+     * @param nbSamples Number of particles checked, spread over the whole set
+     * @return Relative error of the acceleration, |a_fmm - a_exact| / |a_exact|
+     */
+    MultipoleError measureError(const std::vector<Particle>& particles, std::size_t nbSamples) const;
+
+    int getOrder() const {return m_order;}
+    void setOrder(int order) {m_order = order;}
+
+    float getSoftening() const {return m_softening;}
+    void setSoftening(float softening) {m_softening = softening;}
+
+    std::size_t getNbNodes() const {return m_nodes.size();}
+    std::size_t getNbM2L() const {return m_m2lSources.size();}
+    std::size_t getNbP2P() const {return m_p2pSources.size();}
+
+    static constexpr int maxOrder{40};
+    static constexpr std::uint32_t leafSize{32};
+
+private:
+    using Complex = std::complex<double>;
+
+    struct Node {
+        Complex center;
+        double halfSize;
+        std::uint32_t begin;      ///< Particles m_sortedParticles[begin] to m_sortedParticles[end - 1]
+        std::uint32_t end;
+        std::uint32_t parent;
+        std::uint32_t firstChild; ///< Children are consecutive, none for a leaf
+        std::uint32_t nbChildren;
+        std::uint32_t m2lBegin;   ///< Well-separated boxes, m_m2lSources[m2lBegin] to m_m2lSources[m2lEnd - 1]
+        std::uint32_t m2lEnd;
+        std::uint32_t p2pBegin;   ///< Leaves summed directly, only for a leaf
+        std::uint32_t p2pEnd;
+
+        bool isLeaf() const {return nbChildren == 0;}
+    };
+
+    void buildTree();
+    void splitNode(std::uint32_t index);
+    void buildInteractionLists(std::uint32_t target, std::size_t candidatesBegin, std::size_t candidatesEnd);
+    bool wellSeparated(const Node& target, const Node& source) const;
+    void upwardPass();
+    void downwardPass();
+    void evaluateLeaves(double gravitationalConstant);
+
+    Complex* getMultipole(std::uint32_t node) {return &m_multipoles[static_cast<std::size_t>(node) * (m_order + 1)];}
+    Complex* getLocal(std::uint32_t node) {return &m_locals[static_cast<std::size_t>(node) * (m_order + 1)];}
+
+
+    ThreadPool& m_threadPool;
+    int m_order{16};
+    float m_softening{0.0f};
+
+    // Particles as doubles, in their original order
+    std::vector<Complex> m_positions;
+    std::vector<double> m_masses;
+
+    /// Particle indices sorted by box, and their positions and masses in that order for the near field
+    std::vector<std::uint32_t> m_sortedParticles;
+    std::vector<Complex> m_sortedPositions;
+    std::vector<double> m_sortedMasses;
+
+    /// Breadth first, the boxes of a level are consecutive: m_nodes[m_levelOffsets[l]] to m_nodes[m_levelOffsets[l + 1] - 1]
+    std::vector<Node> m_nodes;
+    std::vector<std::uint32_t> m_levelOffsets;
+    std::vector<std::uint32_t> m_leaves;
+
+    std::vector<std::uint32_t> m_m2lSources;
+    std::vector<std::uint32_t> m_p2pSources;
+
+    /// Boxes still to check against the target of the traversal, used as a stack
+    std::vector<std::uint32_t> m_candidates;
+
+    /// Expansion coefficients, m_order + 1 per box
+    std::vector<Complex> m_multipoles;
+    std::vector<Complex> m_locals;
+
+    /// Binomial coefficients C(n, k) up to n = 2 * maxOrder, row-major
+    std::vector<double> m_binomials;
+
+    std::vector<Eigen::Vector2f> m_accelerations;
+    std::vector<double> m_potentials;
+    double m_potentialEnergy{0.0};
+    double m_gravitationalConstant{0.0};
+
+    double getBinomial(int n, int k) const {return m_binomials[static_cast<std::size_t>(n) * (2 * maxOrder + 1) + k];}
+};
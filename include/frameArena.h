@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+
+/**
+ * @class FrameArena
+ * @brief Monotonic scratch memory for the data that only lives during one frame
+ * @details Allocations bump a pointer in an owned buffer and are never freed one by one, reset()
+ *          rewinds the whole buffer at the frame boundary. Containers take it through getResource()
+ *          (std::pmr). A frame needing more than the buffer falls back to the heap, and the buffer
+ *          grows by that amount at the next reset(): after a few frames the arena fits the peak frame
+ *          and the heap is no longer touched.
+ * @warning Whatever was allocated in the arena is invalid after reset()
+ * @author Axel LT
+ * @since 2026-10-19
+ */
+class FrameArena {
+public:
+    /**
+     * @brief Allocate the buffer
+     * @param capacity Initial size of the buffer (bytes)
+     */
+    explicit FrameArena(std::size_t capacity = defaultCapacity);
+
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    std::pmr::memory_resource* getResource() {return &*m_resource;}
+
+    /**
+     * @brief Free everything allocated since the last reset, at a frame boundary
+     * @details The buffer is reallocated larger if the frame overflowed it.
+     */
+    void reset();
+
+    std::size_t getCapacity() const {return m_capacity;}
+    std::size_t getNbGrowths() const {return m_nbGrowths;}
+
+    static constexpr std::size_t defaultCapacity{std::size_t{1} << 20};
+
+private:
+    /// Heap fallback of the arena, remembers how much the frame overflowed
+    class OverflowResource : public std::pmr::memory_resource {
+    public:
+        std::size_t getNbBytes() const {return m_nbBytes;}
+        void resetNbBytes() {m_nbBytes = 0;}
+
+    private:
+        void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+        void do_deallocate(void* pointer, std::size_t bytes, std::size_t alignment) override;
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {return this == &other;}
+
+        std::size_t m_nbBytes{0};
+    };
+
+    void allocateBuffer(std::size_t capacity);
+
+
+    std::unique_ptr<std::byte[]> m_buffer;
+    std::size_t m_capacity{0};
+    std::size_t m_nbGrowths{0};
+    OverflowResource m_overflow;
+    std::optional<std::pmr::monotonic_buffer_resource> m_resource;
+};
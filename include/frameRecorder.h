@@ -0,0 +1,108 @@
+#pragma once
+
+#include <SDL3/SDL.h>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "map.h"
+#include "particle.h"
+#include "threadPool.h"
+#include "offlineRenderer.h"
+#include "asyncFileWriter.h"
+
+/**
+ * @class FrameRecorder
+ * @brief Records movie frames on a background thread so that the simulation never waits for the raster
+ * @details record() only copies the particles, the obstacles and the camera into a free snapshot.
+ *          The recorder thread renders the snapshots with its own thread pool and OfflineRenderer,
+ *          encodes them as PPM and hands them to the AsyncFileWriter.
+ *          Two snapshots alternate: one is filled while the other is rendered, their buffers are reused.
+ * @note record() blocks when the previous snapshot is still waiting to be rendered, this is the only backpressure
+ * @author Axel LT
+ * @since 2026-10-19
+ */
+class FrameRecorder {
+public:
+    /**
+     * @brief Start the recorder thread
+     * @param width Frame width in pixels
+     * @param height Frame height in pixels
+     * @param map Map of the simulation, gives the size of the snapshot maps
+     * @param nbThreads Threads rasterizing a frame, 0 for one per hardware thread
+     * @param fileWriter Writer of the encoded frames, must outlive the recorder
+     * @param directory Directory the frame_XXXXXX.ppm files are written to, must exist
+     */
+    FrameRecorder(int width, int height, const Map& map, unsigned nbThreads, AsyncFileWriter& fileWriter, std::string directory);
+
+    /**
+     * @brief Render and push the frame still waiting, then stop the recorder thread
+     */
+    ~FrameRecorder();
+
+    FrameRecorder(const FrameRecorder&) = delete;
+    FrameRecorder& operator=(const FrameRecorder&) = delete;
+
+    int getWidth() const {return m_width;}
+    int getHeight() const {return m_height;}
+    const std::string& getDirectory() const {return m_directory;}
+
+    OfflineRenderer::Style getStyle() const {return m_style;}
+    void setStyle(OfflineRenderer::Style style) {m_style = style;}
+
+    /**
+     * @brief Get the number of frames recorded so far, rendered or not
+     * @return Number of calls to record()
+     */
+    int getNbRecordedFrames() const {return m_nbRecordedFrames;}
+
+    /**
+     * @brief Queue a frame of the current state
+     * @param particles Particles of the simulation
+     * @param map Map drawn as background, its obstacles are copied
+     * @param camera Portion of the map to render (Viewport semantics)
+     */
+    void record(const std::vector<Particle>& particles, const Map& map, const SDL_FRect camera);
+
+private:
+    /// Copy of the state rendered as one frame
+    struct Snapshot {
+        explicit Snapshot(const Map& sourceMap) : map(sourceMap.getNbColumns(), sourceMap.getNbRows(), static_cast<int>(sourceMap.getSquareSize())) {}
+
+        std::vector<Particle> particles;
+        Map map;
+        SDL_FRect camera{};
+        OfflineRenderer::Style style{OfflineRenderer::Style::discs};
+        int index{0};
+    };
+
+    void recorderLoop();
+
+
+    int m_width;
+    int m_height;
+    OfflineRenderer::Style m_style{OfflineRenderer::Style::discs};
+    int m_nbRecordedFrames{0};
+
+    AsyncFileWriter& m_fileWriter;
+    std::string m_directory;
+
+    /// Only used by the recorder thread
+    ThreadPool m_threadPool;
+    OfflineRenderer m_renderer;
+
+    Snapshot m_snapshots[2];
+
+    std::thread m_recorder;
+
+    std::mutex m_mutex;
+    std::condition_variable m_hasWork;
+    std::condition_variable m_hasRoom;
+
+    /// Snapshot filled by record(), the other one belongs to the recorder thread
+    int m_fillIndex{0};
+    bool m_hasPending{false};
+    bool m_stopping{false};
+};
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "particleStore.h"
+
+/**
+ * @class HistoryBuffer
+ * @brief Bounded in-memory history of the last steps, to rewind a live run
+ * @details Every recorded step is either a keyframe (full copy: handle, mass, position and velocity
+ *          of each particle) or a delta against the step before it. Each particle is predicted from the
+ *          previous step: position moved as in Particle::move, velocity unchanged. A delta only holds
+ *          the particles that differ from their prediction (collision, wall, pair force): the number
+ *          of particles skipped before them, then the zigzag varints of the difference between the
+ *          float bits and the prediction. Undisturbed particles cost almost nothing, against 28 bytes
+ *          in a keyframe, and the state comes back bit for bit. A keyframe is written every keyframeInterval steps and whenever the
+ *          population changed (spawn, merge, reorder, loaded checkpoint), deltas never cross one.
+ *          The steps are written one after the other in a byte ring of the size of the memory budget,
+ *          allocated once: once warmed up, recording never touches the heap. When the budget is
+ *          exceeded or the ring has no room left, the oldest keyframe and its deltas are dropped. When
+ *          the newest keyframe and its deltas fill the whole budget, the step is written as a new keyframe.
+ * @author Axel LT
+ * @since 2026-10-19
+ */
+class HistoryBuffer {
+public:
+    /**
+     * @brief Record the state of a step
+     * @details The history is cleared first if the step doesn't follow the newest one.
+     * @param particles Particles of the simulation
+     * @param step Simulation step of the particles
+     * @param deltaTime Physics time of the step that led to this state (s)
+     */
+    void record(const ParticleStore& particles, std::uint64_t step, float deltaTime);
+
+    /**
+     * @brief Bring back the particles of a recorded step
+     * @param step Step between getOldestStep() and getNewestStep()
+     * @param particles Particles of the simulation, replaced with their handles of that step
+     * @throws HistoryError If the step is not in the history
+     */
+    void restore(std::uint64_t step, ParticleStore& particles);
+
+    /**
+     * @brief Forget the steps after a step, the next one recorded follows it
+     * @details Called when the simulation resumes from a restored step.
+     * @param step Step to keep as the newest one
+     * @throws HistoryError If the step is not in the history
+     */
+    void truncateAfter(std::uint64_t step);
+
+    void clear();
+
+    /**
+     * @brief Set the memory budget of the steps
+     * @details A larger budget than the storage clears the history, the storage is reallocated at the next record.
+     * @param bytes Budget (bytes)
+     */
+    void setMemoryBudget(std::size_t bytes);
+    std::size_t getMemoryBudget() const {return m_memoryBudget;}
+
+    void setKeyframeInterval(int interval) {m_keyframeInterval = interval;}
+    int getKeyframeInterval() const {return m_keyframeInterval;}
+
+    bool empty() const {return m_nbEntries == 0;}
+    std::uint64_t getOldestStep() const {return getEntry(0).step;}
+    std::uint64_t getNewestStep() const {return getEntry(m_nbEntries - 1).step;}
+    std::size_t getNbSteps() const {return m_nbEntries;}
+    std::size_t getNbKeyframes() const {return m_nbKeyframes;}
+    std::size_t getMemoryUsage() const {return m_memoryUsage;}
+
+    /// Size of a keyframe particle, for comparison with the average size of a step
+    static constexpr std::size_t keyframeParticleSize{sizeof(std::uint64_t) + 5 * sizeof(std::uint32_t)};
+
+private:
+    /// Particles as raw bits, so the deltas are lossless
+    struct State {
+        std::vector<std::uint64_t> ids;
+        std::vector<std::int32_t> masses;
+        std::vector<std::uint32_t> x;
+        std::vector<std::uint32_t> y;
+        std::vector<std::uint32_t> velocityX;
+        std::vector<std::uint32_t> velocityY;
+
+        std::size_t size() const {return ids.size();}
+        void resize(std::size_t size);
+    };
+
+    struct Entry {
+        std::uint64_t step;
+        float deltaTime;
+        bool keyframe;
+        std::size_t offset; ///< First byte in m_storage
+        std::size_t size;
+    };
+
+    void capture(const ParticleStore& particles, State& state) const;
+    void encodeKeyframe(const State& state, std::vector<std::uint8_t>& bytes) const;
+    void encodeDelta(const State& previous, const State& state, float deltaTime, std::vector<std::uint8_t>& bytes) const;
+    void decodeKeyframe(const Entry& entry, State& state) const;
+    void decodeDelta(const Entry& entry, State& state) const;
+    const State& decode(std::uint64_t step);
+    bool store(std::uint64_t step, float deltaTime, bool keyframe);
+    bool findFreeBytes(std::size_t size, std::size_t& offset) const;
+    std::size_t findEntry(std::uint64_t step) const;
+    void pushEntry(const Entry& entry);
+    void dropOldestKeyframe();
+
+    /// Entry of the index-th oldest step
+    const Entry& getEntry(std::size_t index) const {return m_entries[(m_firstEntry + index) % m_entries.size()];}
+    static std::size_t getEntrySize(const Entry& entry) {return sizeof(Entry) + entry.size;}
+
+
+    /// Ring of the entries, from m_firstEntry, only grows while the history fills the budget for the first time
+    std::vector<Entry> m_entries;
+    std::size_t m_firstEntry{0};
+    std::size_t m_nbEntries{0};
+
+    /// Ring of the bytes of the entries
+    std::unique_ptr<std::uint8_t[]> m_storage;
+    std::size_t m_storageSize{0};
+
+    std::size_t m_nbKeyframes{0};
+    std::size_t m_memoryUsage{0};
+    std::size_t m_memoryBudget{std::size_t{256} << 20};
+    int m_keyframeInterval{256};
+    int m_stepsSinceKeyframe{0};
+
+    /// State of the newest step, delta base of the next one
+    State m_newest;
+    State m_captured;
+    std::vector<std::uint8_t> m_bytes;
+
+    /// Last decoded step, scrubbing forward from it only applies the deltas in between
+    State m_cursor;
+    std::uint64_t m_cursorStep{0};
+    bool m_cursorValid{false};
+
+    std::vector<Particle> m_restoredParticles;
+    std::vector<ParticleHandle> m_restoredHandles;
+};
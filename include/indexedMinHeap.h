@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+/**
+ * @class IndexedMinHeap
+ * @brief Binary min-heap holding one key per index in [0, size)
+ * @details Unlike std::priority_queue the key of any index can be changed in O(log n),
+ *          so each particle keeps exactly one entry (its next event) instead of piling up stale ones.
+ * @author Axel LT
+ * @since 2026-10-19
+ */
+class IndexedMinHeap {
+public:
+    /**
+     * @brief Reset the heap to size indices, all with an infinite key
+     * @param size Number of indices
+     */
+    void reset(std::size_t size) {
+        m_keys.assign(size, std::numeric_limits<double>::infinity());
+        m_heap.resize(size);
+        m_positions.resize(size);
+
+        for (std::uint32_t i = 0; i < size; ++i) {
+            m_heap[i] = i;
+            m_positions[i] = i;
+        }
+    }
+
+    bool empty() const {return m_heap.empty();}
+
+    /// Index with the smallest key
+    std::uint32_t top() const {return m_heap.front();}
+
+    /// Smallest key
+    double topKey() const {return m_keys[m_heap.front()];}
+
+    double getKey(std::uint32_t index) const {return m_keys[index];}
+
+    /**
+     * @brief Change the key of an index
+     * @param index Index to update
+     * @param key New key
+     */
+    void update(std::uint32_t index, double key) {
+        const double oldKey{m_keys[index]};
+        m_keys[index] = key;
+
+        if (key < oldKey) {
+            siftUp(m_positions[index]);
+        } else {
+            siftDown(m_positions[index]);
+        }
+    }
+
+private:
+    void swapEntries(std::size_t a, std::size_t b) {
+        std::uint32_t indexA{m_heap[a]};
+        m_heap[a] = m_heap[b];
+        m_heap[b] = indexA;
+
+        m_positions[m_heap[a]] = static_cast<std::uint32_t>(a);
+        m_positions[m_heap[b]] = static_cast<std::uint32_t>(b);
+    }
+
+    void siftUp(std::size_t position) {
+        while (position > 0) {
+            const std::size_t parent{(position - 1) / 2};
+
+            if (m_keys[m_heap[parent]] <= m_keys[m_heap[position]]) {
+                return;
+            }
+
+            swapEntries(parent, position);
+            position = parent;
+        }
+    }
+
+    void siftDown(std::size_t position) {
+        const std::size_t size{m_heap.size()};
+
+        while (true) {
+            const std::size_t left{2 * position + 1};
+            const std::size_t right{left + 1};
+            std::size_t smallest{position};
+
+            if (left < size && m_keys[m_heap[left]] < m_keys[m_heap[smallest]]) {
+                smallest = left;
+            }
+            if (right < size && m_keys[m_heap[right]] < m_keys[m_heap[smallest]]) {
+                smallest = right;
+            }
+            if (smallest == position) {
+                return;
+            }
+
+            swapEntries(smallest, position);
+            position = smallest;
+        }
+    }
+
+
+    /// Key of each index
+    std::vector<double> m_keys;
+
+    /// Heap of indices
+    std::vector<std::uint32_t> m_heap;
+
+    /// Position of each index in m_heap
+    std::vector<std::uint32_t> m_positions;
+};
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "map.h"
+#include "particle.h"
+#include "threadPool.h"
+#include "philox.h"
+
+/**
+ * @brief Kind of initial particle distribution
+ */
+enum class InitialCondition {
+    lattice,           ///< Square lattice filling the map, random directions with speeds up to speed
+    plummer,           ///< Projected Plummer sphere at the map center, isotropic dispersion following the Plummer profile
+    exponentialDisk,   ///< Exponential disk rotating counterclockwise at speed (flat rotation curve past the scale length)
+    collidingClusters, ///< Two Plummer spheres on a collision course at speed with a small impact parameter
+    thermalGas         ///< Jittered lattice with Maxwell-Boltzmann velocities at temperature
+};
+
+/**
+ * @brief Parameters of InitialConditions::generate
+ */
+struct InitialConditionSettings {
+    InitialCondition type{InitialCondition::lattice};
+    int nbParticles{1000};
+    std::uint64_t seed{0};
+    int minMass{static_cast<int>(0.01f * Particle::sharedParticleMass)};
+    int maxMass{static_cast<int>(0.1f * Particle::sharedParticleMass)};
+    float speed{1000.0f};        ///< Velocity scale (px/s), see InitialCondition
+    float temperature{1.0e6f};   ///< kT of the thermal gas (J)
+};
+
+/**
+ * @class InitialConditions
+ * @brief Parallel and reproducible generators of initial particle distributions
+ * @details Particle i only draws from the Philox counters (i, block) under the seed, so the
+ *          particles are generated by the thread pool and the result is the same for any number
+ *          of threads. The draws are written into a plain buffer in parallel, the particles are
+ *          then built from it in a single pass.
+ *          A large population can be generated in chunks (begin, then generateSome until it is done),
+ *          e.g. in job slices, the result is the same as a single generate().
+ * @note Unlike Simulation::spawnDestroyParticles there is no overlap test: the lattice and the
+ *       thermal gas don't overlap as long as the particles fit in a lattice cell, the clustered
+ *       distributions do overlap in their dense cores.
+ * @author Axel LT
+ * @since 2026-10-19
+ */
+class InitialConditions {
+public:
+    explicit InitialConditions(ThreadPool& threadPool) : m_threadPool(threadPool) {}
+
+    /**
+     * @brief Replace the particles with a new distribution
+     * @param settings Kind of distribution and its parameters
+     * @param map Map the particles are placed on (clamped inside)
+     * @param particles Particles to replace
+     */
+    void generate(const InitialConditionSettings& settings, const Map& map, std::vector<Particle>& particles);
+
+    /**
+     * @brief Start a generation in chunks, the particles are emptied
+     * @param settings Kind of distribution and its parameters
+     * @param map Map the particles are placed on (clamped inside)
+     * @param particles Particles to replace
+     */
+    void begin(const InitialConditionSettings& settings, const Map& map, std::vector<Particle>& particles);
+
+    /**
+     * @brief Append the next particles of the generation started by begin()
+     * @param map Same map as in begin()
+     * @param particles Same particles as in begin(), untouched in between
+     * @param count Maximum number of particles to append
+     * @return True once every particle is generated
+     */
+    bool generateSome(const Map& map, std::vector<Particle>& particles, std::size_t count);
+
+    /**
+     * @brief Get the number of particles of the current generation
+     * @return Population asked to begin()
+     */
+    std::size_t getNbParticles() const {return m_nbParticles;}
+
+private:
+    /// Geometry shared by all the particles of a generation
+    struct Layout {
+        float width;
+        float height;
+        float scale;       ///< Smallest side of the map
+        int nbColumns;     ///< Lattices
+        int nbRows;
+        float cellWidth;
+        float cellHeight;
+    };
+
+    /// Draws of one particle, center and velocity
+    struct Draw {
+        int mass;
+        float x;
+        float y;
+        float velocityX;
+        float velocityY;
+    };
+
+    Draw drawParticle(std::size_t i) const;
+
+
+    ThreadPool& m_threadPool;
+
+    /// Generation started by begin()
+    InitialConditionSettings m_settings;
+    Layout m_layout{};
+    Philox m_philox{0};
+    std::size_t m_nbParticles{0};
+
+    /// Draws of the current chunk, kept between calls to avoid reallocating
+    std::vector<Draw> m_draws;
+};
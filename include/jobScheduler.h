@@ -0,0 +1,76 @@
+#pragma once
+
+#include <deque>
+#include <functional>
+#include <string>
+#include <string_view>
+
+/**
+ * @class JobScheduler
+ * @brief Runs heavy maintenance work in slices under a per-frame time budget
+ * @details A job is a slice function called again and again until it reports it is done.
+ *          Each frame run() calls slices of the queued jobs, in submission order, until the
+ *          budget is spent, so a big UI action is spread over several frames instead of freezing one.
+ *          Jobs run on the main thread at a fixed point of the frame: what they change is
+ *          committed at a frame boundary and the physics never sees a half-done slice.
+ * @note At least one slice runs per frame, so a slice should stay small (one particle, a few rows...)
+ * @author Axel LT
+ * @since 2026-10-19
+ */
+class JobScheduler {
+public:
+    /// Does a small piece of work, returns true when the job is done
+    using Slice = std::function<bool()>;
+
+    /// Returns the progress of the job between 0 and 1
+    using Progress = std::function<float()>;
+
+    /**
+     * @brief Queue a job
+     * @param name Name shown in the ImGui window
+     * @param slice Slice function
+     * @param progress Progress function, nullptr if the progress is unknown
+     */
+    void submit(std::string name, Slice slice, Progress progress = nullptr);
+
+    /**
+     * @brief Run job slices until the budget is spent or there is nothing left to do
+     * @param budgetMs Time budget in milliseconds
+     */
+    void run(float budgetMs);
+
+    /**
+     * @brief Check if a job with this name is queued
+     * @param name Job name
+     * @return True if queued or running
+     */
+    bool contains(std::string_view name) const;
+
+    bool isIdle() const {return m_jobs.empty();}
+    std::size_t getNbJobs() const {return m_jobs.size();}
+
+    /**
+     * @brief Get the name of the running job
+     * @return Name, empty if idle
+     */
+    const std::string& getCurrentName() const;
+
+    /**
+     * @brief Get the progress of the running job
+     * @return Progress between 0 and 1, negative if unknown or idle
+     */
+    float getCurrentProgress() const;
+
+    /// Time spent in the last run() in milliseconds
+    float getLastRunMs() const {return m_lastRunMs;}
+
+private:
+    struct Job {
+        std::string name;
+        Slice slice;
+        Progress progress;
+    };
+
+    std::deque<Job> m_jobs;
+    float m_lastRunMs{0.0f};
+};
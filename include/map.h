@@ -1,11 +1,15 @@
 #pragma once
 
 #include <SDL3/SDL.h>
+#include <cstdint>
+#include <vector>
 
 /**
  * @class Map
  * @brief Represents the simulation map
  * @details The map is made by "hand" using a surface and writing pixels.
+ *          In unbounded mode the map only marks where the particles are spawned: nothing clamps
+ *          them to it nor bounces them off its sides (see SparseGrid for the open space).
  * @author Axel LT
  * @since 2026-02-17
  */
@@ -13,7 +17,8 @@ class Map {
 public:
     Map(int nbColumns, int nbRows, int size) : m_nbColumns(static_cast<float>(nbColumns)),
                                                m_nbRows(static_cast<float>(nbRows)),
-                                               m_size(static_cast<float>(size)) {}
+                                               m_size(static_cast<float>(size)),
+                                               m_solidCells(static_cast<std::size_t>(nbColumns) * static_cast<std::size_t>(nbRows), 0) {}
     ~Map() {SDL_DestroyTexture(m_texture);}
 
     /**
@@ -28,12 +33,81 @@ public:
      */
     float getHeight() const {return m_nbRows * m_size;}
 
+    /**
+     * @brief Get the size of a map square
+     * @return Square size in pixels
+     */
+    float getSquareSize() const {return m_size;}
+
+    /**
+     * @brief Open or close the sides of the map
+     * @param unbounded True to let the particles leave the map
+     */
+    void setUnbounded(bool unbounded) {m_unbounded = unbounded;}
+    bool isUnbounded() const {return m_unbounded;}
+
+    int getNbColumns() const {return static_cast<int>(m_nbColumns);}
+    int getNbRows() const {return static_cast<int>(m_nbRows);}
+
+    /**
+     * @brief Check if a square is a solid obstacle
+     * @param column Column of the square
+     * @param row Row of the square
+     * @return True if solid, the squares outside the map are not
+     */
+    bool isSolid(int column, int row) const {
+        return column >= 0 && row >= 0 && column < getNbColumns() && row < getNbRows()
+            && m_solidCells[static_cast<std::size_t>(row) * getNbColumns() + column];
+    }
+
+    /**
+     * @brief Make a square solid or free, the texture is not updated (see updateTexture)
+     * @param column Column of the square, inside the map
+     * @param row Row of the square, inside the map
+     * @param solid True for an obstacle
+     */
+    void setSolid(int column, int row, bool solid) {m_solidCells[static_cast<std::size_t>(row) * getNbColumns() + column] = solid;}
+
+    /**
+     * @brief Free every square
+     */
+    void clearSolidCells() {m_solidCells.assign(m_solidCells.size(), 0);}
+
+    /**
+     * @brief Copy the obstacles of another map of the same size, the texture is not updated
+     * @param other Map to copy the obstacles from
+     */
+    void copySolidCells(const Map& other) {m_solidCells = other.m_solidCells;}
+
+    bool hasSolidCells() const;
+
+    /**
+     * @brief Load the obstacles from a bitmap, the texture is not updated (see updateTexture)
+     * @details The bitmap is stretched over the map, a square is solid when the pixel at its center is dark.
+     * @param path Path of the BMP file
+     */
+    void loadSolidCells(const char* path);
+
     /**
      * @brief Set the texture for the map
      * @param renderer SDL_Renderer to render to
      */
     void setTexture(SDL_Renderer* renderer);
 
+    /**
+     * @brief Redraw every square of the texture, after the obstacles changed
+     * @param renderer SDL_Renderer the texture was created with
+     */
+    void updateTexture(SDL_Renderer* renderer);
+
+    /**
+     * @brief Redraw one square of the texture, after it was painted
+     * @param renderer SDL_Renderer the texture was created with
+     * @param column Column of the square
+     * @param row Row of the square
+     */
+    void updateTexture(SDL_Renderer* renderer, int column, int row);
+
 
     /**
      * @brief Render the map according to the current viewport
@@ -43,6 +117,9 @@ public:
     void render(SDL_Renderer* renderer, const SDL_FRect gameViewport);
 
 private:
+    void drawSquare(SDL_Renderer* renderer, int column, int row);
+
+
     /// SDL texture representing the map
     SDL_Texture* m_texture{nullptr};
 
@@ -52,4 +129,10 @@ private:
 
     /// Map square size in pixels
     float m_size;
+
+    /// The sides don't hold the particles
+    bool m_unbounded{false};
+
+    /// One byte per square in row-major order, non-zero for an obstacle
+    std::vector<std::uint8_t> m_solidCells;
 };
\ No newline at end of file
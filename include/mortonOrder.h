@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "map.h"
+#include "particle.h"
+#include "threadPool.h"
+
+/**
+ * @class MortonOrder
+ * @brief Computes a storage order of the particles following the Morton (Z-order) curve
+ * @details Particles close on the map end up close in memory, so the passes looking at
+ *          neighbours hit the cache. The centers are quantized on a 65536 x 65536 grid
+ *          covering the map, the two coordinates are bit-interleaved into a 32 bits key
+ *          (computed in parallel) and the keys are sorted with a stable LSD radix sort.
+ * @author Axel LT
+ * @since 2026-10-19
+ */
+class MortonOrder {
+public:
+    explicit MortonOrder(ThreadPool& threadPool) : m_threadPool(threadPool) {}
+
+    /**
+     * @brief Compute the Morton order of the particles
+     * @param particles Particles in their current storage order
+     * @param map Map used to quantize the coordinates
+     * @return order[k] is the current index of the particle that should be stored at k
+     */
+    const std::vector<std::uint32_t>& computeOrder(const std::vector<Particle>& particles, const Map& map);
+
+    /**
+     * @brief Interleave the bits of two 16 bits coordinates
+     * @param x Quantized x coordinate, on the even bits
+     * @param y Quantized y coordinate, on the odd bits
+     * @return Morton key
+     */
+    static std::uint32_t interleave(std::uint16_t x, std::uint16_t y);
+
+private:
+    ThreadPool& m_threadPool;
+
+    /// Radix sort buffers, kept between calls to avoid reallocating
+    std::vector<std::uint32_t> m_keys;
+    std::vector<std::uint32_t> m_order;
+    std::vector<std::uint32_t> m_keysScratch;
+    std::vector<std::uint32_t> m_orderScratch;
+};
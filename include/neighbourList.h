@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "Eigen/Dense"
+
+#include "map.h"
+#include "particle.h"
+#include "sparseGrid.h"
+
+/**
+ * @class NeighbourList
+ * @brief Cached Verlet neighbour lists with a skin distance
+ * @details Each particle i keeps the particles j > i closer than their interaction range plus the skin.
+ *          As long as no particle moved more than half the skin since the build, every pair that can
+ *          interact is still in the lists, so the neighbour search (a cell grid) is skipped.
+ *          The grid covers the map, or only its occupied cells when the map is unbounded (see SparseGrid).
+ *          The lists are stored as a flat CSR array: the neighbours of i are
+ *          getNeighbours()[getOffsets()[i]] to getNeighbours()[getOffsets()[i + 1] - 1].
+ * @warning The lists refer to particle indices, invalidate() them whenever particles are added, removed or reordered
+ * @author Axel LT
+ * @since 2026-10-19
+ */
+class NeighbourList {
+public:
+    float getSkin() const {return m_skin;}
+
+    /**
+     * @brief Set the skin distance, the lists are rebuilt on the next update
+     * @param skin Extra distance kept in the lists (pixels)
+     */
+    void setSkin(float skin) {m_skin = skin; invalidate();}
+
+    /**
+     * @brief Force a rebuild on the next update
+     */
+    void invalidate() {m_valid = false;}
+
+    /**
+     * @brief Rebuild the lists if they are invalid or if some particle moved more than half the skin
+     * @param particles Particles of the simulation
+     * @param map Map the particles live in
+     * @param interaction Interaction used, gives the interaction range
+     * @return True if the lists have been rebuilt
+     */
+    bool update(const std::vector<Particle>& particles, const Map& map, PairInteraction interaction);
+
+    const std::vector<std::uint32_t>& getOffsets() const {return m_offsets;}
+    const std::vector<std::uint32_t>& getNeighbours() const {return m_neighbours;}
+
+    /// Statistics shown in the ImGui window
+    std::uint64_t getNbBuilds() const {return m_nbBuilds;}
+    std::uint64_t getNbUpdates() const {return m_nbUpdates;}
+
+private:
+    bool needsRebuild(const std::vector<Particle>& particles) const;
+    void build(const std::vector<Particle>& particles, const Map& map, PairInteraction interaction);
+
+
+    float m_skin{20.0f};
+    bool m_valid{false};
+    PairInteraction m_interaction{PairInteraction::hardSphere};
+
+    /// Centers at the last build, to measure the displacements
+    std::vector<Eigen::Vector2f> m_referenceCenters;
+
+    /// CSR lists
+    std::vector<std::uint32_t> m_offsets;
+    std::vector<std::uint32_t> m_neighbours;
+
+    /// Cell grid used by the build, particles of cell c are m_cellParticles[m_cellOffsets[c]] to m_cellParticles[m_cellOffsets[c + 1] - 1]
+    std::vector<std::uint32_t> m_particleCells;
+    std::vector<std::uint32_t> m_cellOffsets;
+    std::vector<std::uint32_t> m_cellParticles;
+
+    /// Cells of an unbounded map, see SparseGrid
+    SparseGrid m_sparseGrid;
+
+    std::uint64_t m_nbBuilds{0};
+    std::uint64_t m_nbUpdates{0};
+};
@@ -0,0 +1,170 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Eigen/Dense"
+
+#include "particle.h"
+
+/**
+ * @struct CompensatedSum
+ * @brief Neumaier (improved Kahan) summation, keeps the rounding error of large float sums
+ */
+struct CompensatedSum {
+    double sum{0.0};
+    double compensation{0.0};
+
+    void add(double value) {
+        const double total{sum + value};
+
+        if (std::abs(sum) >= std::abs(value)) {
+            compensation += (sum - total) + value;
+        } else {
+            compensation += (value - total) + sum;
+        }
+
+        sum = total;
+    }
+
+    double get() const {return sum + compensation;}
+};
+
+/**
+ * @struct ObservableSample
+ * @brief Conserved quantities and moments of the particles at one step
+ */
+struct ObservableSample {
+    double kineticEnergy{0.0};
+    double potentialEnergy{0.0};
+    double totalMass{0.0};
+    Eigen::Vector2d momentum{0.0, 0.0};
+    double angularMomentum{0.0};         ///< About the center of the map
+    Eigen::Vector2d centerOfMass{0.0, 0.0};
+    std::size_t nbParticles{0};
+
+    double getTotalEnergy() const {return kineticEnergy + potentialEnergy;}
+};
+
+/**
+ * @class Observables
+ * @brief Energy, momentum, angular momentum, center of mass and speed histogram of the particles
+ * @details Nothing here loops over the particles: the engines call accumulate() once the velocities
+ *          of the step are final (after the pair impulses), every thread on its own accumulator, and
+ *          endStep() reduces the accumulators in thread order with compensated sums.
+ *          The potential energy added during the step must be the one of the same positions.
+ *          The last samples are kept in ring buffers for the ImGui plots.
+ * @author Axel LT
+ * @since 2026-10-19
+ */
+class Observables {
+public:
+    static constexpr int nbHistogramBins{48};
+    static constexpr std::size_t historySize{512};
+
+    /**
+     * @brief Get ready for the accumulations of a new step
+     * @param nbThreads Number of threads that will call accumulate()
+     * @param mapCenter Point the angular momentum is computed around
+     */
+    void beginStep(unsigned nbThreads, const Eigen::Vector2f& mapCenter);
+
+    /**
+     * @brief Accumulate one particle, call it once per particle between beginStep() and endStep()
+     * @param threadIndex Index of the calling thread, below the nbThreads given to beginStep()
+     * @param particle Particle to accumulate
+     */
+    void accumulate(unsigned threadIndex, const Particle& particle) {
+        Accumulator& accumulator{m_accumulators[threadIndex]};
+
+        const Eigen::Vector2f center{particle.getCenter()};
+        const Eigen::Vector2f velocity{particle.getVelocity()};
+        const double mass{static_cast<double>(particle.getMass())};
+        const double speed{velocity.norm()};
+
+        accumulator.kineticEnergy.add(0.5 * mass * speed * speed);
+        accumulator.mass.add(mass);
+        accumulator.momentumX.add(mass * velocity(0));
+        accumulator.momentumY.add(mass * velocity(1));
+        accumulator.massX.add(mass * center(0));
+        accumulator.massY.add(mass * center(1));
+        accumulator.angularMomentum.add(mass * ((center(0) - m_mapCenter(0)) * velocity(1) - (center(1) - m_mapCenter(1)) * velocity(0)));
+
+        const int bin{static_cast<int>(speed / histogramMaxSpeed * nbHistogramBins)};
+        ++accumulator.histogram[bin < nbHistogramBins ? bin : nbHistogramBins - 1];
+        ++accumulator.nbParticles;
+    }
+
+    /**
+     * @brief Add pair potential energy (see Particle::applyPairForce), from the calling thread 0
+     * @param energy Potential energy (J)
+     */
+    void addPotentialEnergy(double energy) {m_accumulators[0].potentialEnergy.add(energy);}
+
+    /**
+     * @brief Reduce the accumulators, record the sample and fit the speed distribution
+     */
+    void endStep();
+
+    /**
+     * @brief Use the next sample as reference for the energy drift (the particles changed)
+     */
+    void resetReference() {m_hasReference = false;}
+
+    const ObservableSample& getSample() const {return m_sample;}
+
+    /// Relative drift of the total energy since the reference sample
+    double getEnergyDrift() const;
+
+    /// Temperature kT of the Maxwell-Boltzmann fit (J), from equipartition in 2D: mean kinetic energy
+    double getFittedTemperature() const {return m_fittedTemperature;}
+
+    /// Speed histogram of the last step and the fitted Maxwell-Boltzmann counts, bin i covers [i, i + 1) * histogramMaxSpeed / nbHistogramBins
+    const std::array<float, nbHistogramBins>& getHistogram() const {return m_histogram;}
+    const std::array<float, nbHistogramBins>& getFittedHistogram() const {return m_fittedHistogram;}
+
+    /// Ring buffers, oldest value at getHistoryOffset()
+    const std::array<float, historySize>& getTotalEnergyHistory() const {return m_totalEnergyHistory;}
+    const std::array<float, historySize>& getMomentumHistory() const {return m_momentumHistory;}
+    const std::array<float, historySize>& getAngularMomentumHistory() const {return m_angularMomentumHistory;}
+    int getHistoryOffset() const {return static_cast<int>(m_historyOffset);}
+
+    /// Speeds above this go to the last bin (px/s)
+    static constexpr double histogramMaxSpeed{10000.0};
+
+private:
+    /// One per thread, aligned so that two threads never share a cache line
+    struct alignas(64) Accumulator {
+        CompensatedSum kineticEnergy;
+        CompensatedSum potentialEnergy;
+        CompensatedSum mass;
+        CompensatedSum momentumX;
+        CompensatedSum momentumY;
+        CompensatedSum massX;
+        CompensatedSum massY;
+        CompensatedSum angularMomentum;
+        std::array<std::uint32_t, nbHistogramBins> histogram{};
+        std::size_t nbParticles{0};
+    };
+
+    void fitMaxwellBoltzmann();
+
+
+    std::vector<Accumulator> m_accumulators;
+    Eigen::Vector2f m_mapCenter{0.0f, 0.0f};
+
+    ObservableSample m_sample;
+    double m_referenceEnergy{0.0};
+    bool m_hasReference{false};
+
+    double m_fittedTemperature{0.0};
+    std::array<float, nbHistogramBins> m_histogram{};
+    std::array<float, nbHistogramBins> m_fittedHistogram{};
+
+    std::array<float, historySize> m_totalEnergyHistory{};
+    std::array<float, historySize> m_momentumHistory{};
+    std::array<float, historySize> m_angularMomentumHistory{};
+    std::size_t m_historyOffset{0};
+};
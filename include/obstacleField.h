@@ -0,0 +1,118 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include "Eigen/Dense"
+
+#include "map.h"
+
+/**
+ * @class ObstacleField
+ * @brief Signed distance field of the solid squares of a Map, for O(1) particle-obstacle collisions
+ * @details The field is sampled samplesPerSquare times per square side. The exact Euclidean
+ *          distance transform (Felzenszwalb and Huttenlocher, two separable 1D passes) gives, for
+ *          each sample, the distance to the nearest sample of the other kind (solid or free), minus
+ *          half a sample so the zero level sits on the square borders. Queries interpolate the four
+ *          nearest samples: the distance is bilinear, the normal is the gradient of that bilinear patch.
+ *          A query costs the same whatever the number of obstacles.
+ *          The field can be rebuilt in slices (one line of samples at a time, see JobScheduler):
+ *          queries keep reading the previous field until the new one is complete.
+ * @author Axel LT
+ * @since 2026-10-19
+ */
+class ObstacleField {
+public:
+    static constexpr int samplesPerSquare{4};
+
+    /**
+     * @brief Rebuild the field at once
+     * @param map Map and its solid squares
+     */
+    void build(const Map& map);
+
+    /**
+     * @brief Start rebuilding the field, the solid squares are copied so the map can change meanwhile
+     * @param map Map and its solid squares
+     */
+    void startBuild(const Map& map);
+
+    /**
+     * @brief Continue the rebuild started by startBuild
+     * @param nbLines Number of lines of samples to transform
+     * @return True once the new field is in use
+     */
+    bool continueBuild(std::size_t nbLines);
+
+    /// Progress of the rebuild between 0 and 1
+    float getBuildProgress() const;
+
+    bool hasObstacles() const {return m_hasObstacles;}
+
+    /**
+     * @brief Get the signed distance to the obstacles
+     * @param point Point on the map (px)
+     * @return Distance (px), negative inside an obstacle
+     */
+    float getDistance(const Eigen::Vector2f& point) const;
+
+    /**
+     * @brief Get the direction out of the nearest obstacle
+     * @param point Point on the map (px)
+     * @return Unit gradient of the distance, zero where it is flat
+     */
+    Eigen::Vector2f getNormal(const Eigen::Vector2f& point) const;
+
+    /**
+     * @brief Find where a disc moving in a straight line first touches the obstacles
+     * @details Sphere tracing: the distance to the obstacles is a safe step along the path,
+     *          divided by sqrt(2) for the bilinear interpolation and never shorter than
+     *          minTraceStep samples, so the disc stops within that much of the surface.
+     * @param start Center of the disc at the start (px)
+     * @param displacement Move of the center (px)
+     * @param radius Radius of the disc (px)
+     * @return Fraction of the displacement before the contact, -1 if there is none
+     *         (0 if the disc already overlaps and moves further in)
+     */
+    float timeOfImpact(const Eigen::Vector2f& start, const Eigen::Vector2f& displacement, float radius) const;
+
+    /// Distance between two samples (px)
+    float getSpacing() const {return m_spacing;}
+
+    static constexpr float minTraceStep{0.1f};
+
+private:
+    /// Bilinear patch of the four samples around a point
+    struct Patch {
+        float d00, d10, d01, d11;
+        float fx, fy;
+    };
+
+    Patch getPatch(const Eigen::Vector2f& point) const;
+    void transformLine(std::size_t line);
+    void finishBuild();
+
+
+    // Field in use
+    bool m_hasObstacles{false};
+    int m_width{0};
+    int m_height{0};
+    float m_spacing{1.0f};
+    std::vector<float> m_distances;
+
+    // Rebuild in progress: squared distances to the nearest solid and to the nearest free sample
+    bool m_building{false};
+    bool m_buildHasObstacles{false};
+    int m_buildWidth{0};
+    int m_buildHeight{0};
+    float m_buildSpacing{1.0f};
+    std::vector<std::uint8_t> m_buildSolid;
+    std::vector<float> m_distancesToSolid;
+    std::vector<float> m_distancesToFree;
+    std::size_t m_nextLine{0};
+
+    // Scratch buffers of the 1D transform
+    std::vector<float> m_line;
+    std::vector<float> m_lineResult;
+    std::vector<int> m_parabolas;
+    std::vector<float> m_boundaries;
+};
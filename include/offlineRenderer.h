@@ -0,0 +1,99 @@
+#pragma once
+
+#include <SDL3/SDL.h>
+#include <cstdint>
+#include <vector>
+
+#include "map.h"
+#include "particle.h"
+#include "threadPool.h"
+
+/**
+ * @class OfflineRenderer
+ * @brief Headless software rasterizer drawing the simulation into an RGBA framebuffer
+ * @details Used to render movies at any resolution without SDL renderer nor display.
+ *          Particles are binned into square screen tiles, then every tile is rasterized
+ *          independently on the thread pool, so no two threads ever write the same pixel.
+ *          The camera is a rectangle of the map with the Viewport semantics:
+ *          its top left corner and its width are mapped onto the framebuffer width.
+ * @author Axel LT
+ * @since 2026-10-19
+ */
+class OfflineRenderer {
+public:
+    /// How particles are drawn
+    enum class Style {
+        discs,        ///< Anti-aliased discs over the map chessboard, like the live view
+        densitySplats ///< Additive splats tone-mapped on a black background, shows clustering
+    };
+
+    /**
+     * @brief Construct a renderer, the framebuffer is only allocated on the first render
+     * @param width Framebuffer width in pixels
+     * @param height Framebuffer height in pixels
+     * @param threadPool Threads used to rasterize the tiles
+     */
+    OfflineRenderer(int width, int height, ThreadPool& threadPool);
+
+    int getWidth() const {return m_width;}
+    int getHeight() const {return m_height;}
+
+    Style getStyle() const {return m_style;}
+    void setStyle(Style style) {m_style = style;}
+
+    /**
+     * @brief Render all the particles seen by the camera
+     * @param particles Particles of the simulation
+     * @param map Map drawn as background in Style::discs
+     * @param camera Portion of the map to render (Viewport semantics)
+     */
+    void render(const std::vector<Particle>& particles, const Map& map, const SDL_FRect camera);
+
+    /**
+     * @brief Get the last rendered frame
+     * @return RGBA bytes, row by row from the top left corner
+     */
+    const std::vector<std::uint8_t>& getFramebuffer() const {return m_framebuffer;}
+
+    /**
+     * @brief Encode the last rendered frame as a binary PPM (P6) image
+     * @param bytes Buffer receiving the file content, previous content is discarded
+     */
+    void encodePPM(std::vector<std::uint8_t>& bytes) const;
+
+private:
+    /// Screen-space disc of a particle, computed once while binning
+    struct Disc {
+        float x;
+        float y;
+        float radius;
+    };
+
+    void binParticles(const std::vector<Particle>& particles, const SDL_FRect camera);
+    void rasterizeTile(int tile, unsigned threadIndex, const Map& map, const SDL_FRect camera);
+
+
+    int m_width;
+    int m_height;
+    Style m_style{Style::discs};
+
+    ThreadPool& m_threadPool;
+
+    /// Tile side in pixels
+    static constexpr int m_tileSize{64};
+    int m_nbTilesX;
+    int m_nbTilesY;
+
+    std::vector<std::uint8_t> m_framebuffer;
+
+    /// Binning, particles of tile t are m_tileParticles[m_tileOffsets[t]] to m_tileParticles[m_tileOffsets[t + 1] - 1]
+    std::vector<Disc> m_discs;
+    std::vector<std::uint32_t> m_tileOffsets;
+    std::vector<std::uint32_t> m_tileParticles;
+
+    /// Per-thread tile counters used to bin in parallel while keeping the particle order in each tile
+    std::vector<std::uint32_t> m_threadTileCounts;
+
+    /// Per-thread RGBA float accumulation buffer for one tile
+    std::vector<std::vector<float>> m_tileBuffers;
+};
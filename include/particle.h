@@ -1,9 +1,25 @@
 #pragma once
 
 #include <SDL3/SDL.h>
+#include <cmath>
+#include <memory_resource>
+#include <vector>
 #include "Eigen/Dense"
 
 #include "map.h"
+#include "obstacleField.h"
+
+/**
+ * @brief Short-range interaction between two particles
+ * @see Particle::checkSolveCollision
+ * @see Particle::applyPairForce
+ */
+enum class PairInteraction {
+    hardSphere,    ///< Perfectly elastic collisions between hard discs
+    softRepulsion, ///< Harmonic repulsion while the discs overlap
+    lennardJones,  ///< Lennard-Jones potential with its minimum at contact, truncated and shifted
+    merging        ///< Touching discs merge into one (perfectly inelastic), see Particle::merge
+};
 
 /**
  * @class Particle
@@ -41,18 +57,52 @@ public:
 
     /**
      * @brief Set particle coordinates on the map
+     * @details Clamped inside the map unless it is unbounded.
      * @param map Reference to the simulation map
      * @param x X coordinate
      * @param y Y coordinate
      */
     void setCoordinates(const Map &map, float x, float y);
 
+    /**
+     * @brief Set particle coordinates exactly as they were saved, without clamping them to the map
+     * @details A pair collision can leave a particle slightly outside until the next wall check,
+     *          restoring it clamped would change the following steps (see HistoryBuffer).
+     * @param x X coordinate
+     * @param y Y coordinate
+     */
+    void restoreCoordinates(float x, float y) {m_particle.x = x; m_particle.y = y;}
+
     /**
      * @brief Get the SDL floating rectangle representing particle position and size
      * @return SDL_FRect containing particle coordinates and dimensions
      */
     SDL_FRect getParticle() const {return m_particle;}
 
+    /**
+     * @brief Get the particle center
+     * @return Eigen::Vector2f containing the center coordinates (x, y)
+     */
+    Eigen::Vector2f getCenter() const {return {m_particle.x + m_particle.w / 2.0f, m_particle.y + m_particle.h / 2.0f};}
+
+    /**
+     * @brief Get the particle velocity
+     * @return Eigen::Vector2f containing the velocity components (x, y)
+     */
+    Eigen::Vector2f getVelocity() const {return m_velocity;}
+
+    /**
+     * @brief Set the particle velocity
+     * @param velocity New velocity vector
+     */
+    void setVelocity(const Eigen::Vector2f& velocity) {m_velocity = velocity;}
+
+    /**
+     * @brief Get the particle mass
+     * @return Particle mass (kg)
+     */
+    int getMass() const {return m_mass;}
+
     /**
      * @brief Get the particle kinetic energy (J)
      * @return float containing the particle kinetic energy (J)
@@ -63,6 +113,16 @@ public:
     }
 
 
+    /**
+     * @brief Get the diameter of a particle of a given mass
+     * @details The area is proportional to the mass, the reference being the shared particle
+     * @param mass Particle mass
+     * @return Diameter (pixels)
+     */
+    static float getDiameter(int mass) {
+        return static_cast<float>(sharedParticleDiameter) * std::sqrt(static_cast<float>(mass) / static_cast<float>(sharedParticleMass));
+    }
+
     /**
      * @brief Check collision with another particle during particle instanciation
      * @warning Can't be used before solveCollisionParticle as it uses the squared distance
@@ -81,26 +141,118 @@ public:
 
     /**
      * @brief Solve wall collisions and adjust particle position/velocity
-     * @details Clamp the position on the map and reverse the normal component of velocity
+     * @details Clamp the position on the map and reverse the normal component of velocity, nothing in an unbounded map
      * @note Sould be used after moving the particle
      * @param map Reference to the map
      */
     void solveWallCollision(const Map& map);
 
+    /**
+     * @brief Solve the collision with the solid squares of the map
+     * @details Push the particle out along the distance gradient and reflect the normal
+     *          component of its velocity, O(1) whatever the number of obstacles.
+     * @note Sould be used after moving the particle
+     * @param obstacles Distance field of the obstacles
+     * @param restitution Ratio of the normal velocities after and before the impact
+     */
+    void solveObstacleCollision(const ObstacleField& obstacles, float restitution = 1.0f);
+
+    /**
+     * @brief Move during deltaTime, bouncing on the solid squares met on the way
+     * @details The path is traced through the distance field (see ObstacleField::timeOfImpact),
+     *          so a particle moving more than a square per step can't cross a thin wall. The particle
+     *          stops at the contact, reflects and moves for the rest of the time, up to maxObstacleBounces
+     *          times, then solveObstacleCollision fixes what is left of the overlap.
+     * @param obstacles Distance field of the obstacles
+     * @param deltaTime Time elapsed since last frame
+     * @param restitution Ratio of the normal velocities after and before the impact
+     */
+    void moveAgainstObstacles(const ObstacleField& obstacles, float deltaTime, float restitution = 1.0f);
+
+    static constexpr int maxObstacleBounces{4};
+
     /**
      * @brief Check collision with another particle and compute the outcome
      * @param otherParticle References particle we could collide with
+     * @param restitution Coefficient of restitution, 1 for perfectly elastic collisions
      */
-    void checkSolveCollision(Particle& otherParticle);
+    void checkSolveCollision(Particle& otherParticle, float restitution = 1.0f);
 
     /**
-     * @brief Render the particle on the screen
-     * @details Only render the particle if it is in the viewport.
-     * @param renderer SDL_Renderer to render to
+     * @brief Solve the collision with a particle we are touching
+     * @details Unlike checkSolveCollision there is no distance test nor overlap correction,
+     *          used when the time of impact is known (swept collisions).
+     * @param otherParticle References particle we collided with
+     * @param restitution Coefficient of restitution, 1 for perfectly elastic collisions
+     */
+    void solveContactCollision(Particle& otherParticle, float restitution = 1.0f);
+
+    /**
+     * @brief Absorb another particle (perfectly inelastic collision)
+     * @details Mass and momentum are conserved, the merged particle sits at the center of mass
+     *          of the two and its diameter follows the mass rule of the constructor.
+     * @param otherParticle Particle absorbed, to be removed by the caller
+     * @param map Reference to the map, the merged particle is kept inside
+     */
+    void merge(const Particle& otherParticle, const Map& map);
+
+    /**
+     * @brief Get the interaction range of a pair interaction
+     * @param interaction Interaction between the particles
+     * @return Range as a factor of the contact distance (sum of the radii)
+     */
+    static float getInteractionRangeFactor(PairInteraction interaction);
+
+    /**
+     * @brief Apply a soft pair force between this particle and another one during deltaTime
+     * @details Both velocities receive opposite impulses, so the momentum is conserved.
+     *          Nothing happens for PairInteraction::hardSphere (see checkSolveCollision)
+     *          nor for PairInteraction::merging (see merge).
+     * @param otherParticle References particle we interact with
+     * @param interaction Soft interaction to use
+     * @param strength Stiffness of the soft repulsion or depth of the Lennard-Jones well
+     * @param deltaTime Time elapsed since last frame
+     * @return Potential energy of the pair (J)
+     */
+    float applyPairForce(Particle& otherParticle, PairInteraction interaction, float strength, float deltaTime);
+
+    /**
+     * @brief Change the velocity by a body force during deltaTime, the position is left to move
+     * @param acceleration Acceleration of the particle, e.g. from FastMultipole (px/s^2)
+     * @param deltaTime Time elapsed since last frame
+     */
+    void accelerate(const Eigen::Vector2f& acceleration, float deltaTime) {m_velocity += acceleration * deltaTime;}
+
+    /**
+     * @brief Add the particle to a batch of discs drawn with the shared texture
+     * @details Only if it is in the viewport.
+     * @param vertices Batch of discs, four vertices per disc (see renderDiscs)
+     * @param simulationViewport The current simulation viewport
+     * @param screenWidth Width of the screen for scaling
+     * @return True if the particle was added
+     */
+    bool appendDisc(std::pmr::vector<SDL_Vertex>& vertices, const SDL_FRect simulationViewport, const float screenWidth) const {
+        return appendDisc(vertices, m_particle, simulationViewport, screenWidth);
+    }
+
+    /**
+     * @brief Add a disc to a batch drawn with the shared texture
+     * @details Same as the member appendDisc for a rectangle that doesn't come from a Particle (e.g. a remote one, see StateClient).
+     * @param vertices Batch of discs, four vertices per disc (see renderDiscs)
+     * @param disc Rectangle of the disc on the map
      * @param simulationViewport The current simulation viewport
      * @param screenWidth Width of the screen for scaling
+     * @return True if the disc was added
+     */
+    static bool appendDisc(std::pmr::vector<SDL_Vertex>& vertices, const SDL_FRect& disc, const SDL_FRect simulationViewport, const float screenWidth);
+
+    /**
+     * @brief Render a batch of discs in a single draw call
+     * @param renderer SDL_Renderer to render to
+     * @param vertices Four vertices per disc, filled by appendDisc
+     * @param indices Two triangles per disc (0 1 2, 0 2 3 shifted by 4 per disc), at least for the discs of the batch
      */
-    void render(SDL_Renderer* renderer, const SDL_FRect simulationViewport, const float screenWidth);
+    static void renderDiscs(SDL_Renderer* renderer, const std::pmr::vector<SDL_Vertex>& vertices, const std::pmr::vector<int>& indices);
 
 private:
     /**
@@ -118,19 +270,17 @@ private:
      * @brief Compute the velocity components in world coordinates
      * @param otherParticle References particle we collided with
      * @param normalUnitVector Normal unit vector of the collision plane
+     * @param restitution Ratio of the normal relative velocities after and before the impact
      * @see Particle::checkSolveCollision
      */
-    void solveCollision(Particle& otherParticle, const Eigen::Vector2f& normalUnitVector);
+    void solveCollision(Particle& otherParticle, const Eigen::Vector2f& normalUnitVector, float restitution);
 
 
     /// Particle position and size
     SDL_FRect m_particle{0.0f, 0.0f, 0.0f, 0.0f};
 
-    /// Particle viewport for rendering
-    SDL_FRect m_viewport{0.0f, 0.0f, 0.0f, 0.0f};
-
-    /// Particle mass (constant per instance)
-    const int m_mass;
+    /// Particle mass, only changed by merge()
+    int m_mass;
 
     /// Particle velocity components (x, y)
     Eigen::Vector2f m_velocity;
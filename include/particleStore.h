@@ -0,0 +1,141 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Eigen/Dense"
+
+#include "particle.h"
+
+/**
+ * @struct ParticleHandle
+ * @brief Generational handle of a particle in a ParticleStore
+ * @details The slot is reused once the particle is removed, the generation is not:
+ *          a handle kept after the removal is detected as stale instead of aliasing the new particle.
+ */
+struct ParticleHandle {
+    static constexpr std::uint32_t invalidSlot{0xFFFFFFFFu};
+
+    std::uint32_t slot{invalidSlot};
+    std::uint32_t generation{0};
+
+    /// Stable identifier for tools, unique over the whole run
+    std::uint64_t getId() const {return (static_cast<std::uint64_t>(generation) << 32) | slot;}
+    static ParticleHandle fromId(std::uint64_t id) {return {static_cast<std::uint32_t>(id), static_cast<std::uint32_t>(id >> 32)};}
+
+    bool operator==(const ParticleHandle&) const = default;
+};
+
+/**
+ * @class ParticleStore
+ * @brief Dense particle storage with stable generational handles (slot map)
+ * @details The particles stay contiguous so every pass keeps iterating a plain std::vector,
+ *          see getParticles(). A slot table maps each handle to the current index:
+ *          - insert() appends and takes a free slot, O(1)
+ *          - remove() moves the last particle into the hole (swap-to-end) and fixes its slot, O(1)
+ *          - permute() applies a new storage order (Morton reordering) and fixes every slot
+ * @warning Indices change on remove() and permute(), keep handles across frames, not indices
+ * @author Axel LT
+ * @since 2026-10-19
+ */
+class ParticleStore {
+public:
+    /**
+     * @brief Build a particle at the end of the storage
+     * @param mass Particle mass
+     * @param velocity Initial velocity vector
+     * @return Handle of the new particle
+     */
+    ParticleHandle insert(int mass, const Eigen::Vector2f& velocity);
+
+    /**
+     * @brief Remove a particle, the last particle takes its index
+     * @param handle Handle of the particle, must be alive
+     */
+    void remove(ParticleHandle handle);
+
+    /**
+     * @brief Remove the particle stored at an index, the last particle takes its index
+     * @param index Index of the particle
+     */
+    void removeAt(std::size_t index);
+
+    /**
+     * @brief Remove every particle, the handles given so far all become stale
+     */
+    void clear();
+
+    /**
+     * @brief Replace every particle, each one gets a new handle in storage order
+     * @param particles New particles, swapped with the storage (gets the old particles back)
+     */
+    void replace(std::vector<Particle>& particles);
+
+    /**
+     * @brief Replace every particle, each one gets back a handle it had before
+     * @details Used to go back to a saved state (see HistoryBuffer), the handles given since then
+     *          that don't belong to the saved particles become stale.
+     * @param particles New particles, swapped with the storage (gets the old particles back)
+     * @param handles Handle of each new particle, all different
+     */
+    void replace(std::vector<Particle>& particles, const std::vector<ParticleHandle>& handles);
+
+    /**
+     * @brief Store the particles in a new order, the handles stay valid
+     * @param order order[k] is the current index of the particle to store at k
+     */
+    void permute(const std::vector<std::uint32_t>& order);
+
+    /**
+     * @brief Reserve room for a number of particles
+     * @param capacity Number of particles
+     */
+    void reserve(std::size_t capacity);
+
+    bool contains(ParticleHandle handle) const {
+        return handle.slot < m_slots.size() && m_slots[handle.slot].generation == handle.generation
+            && m_slots[handle.slot].index != ParticleHandle::invalidSlot;
+    }
+
+    /// Current index of a live particle
+    std::size_t getIndex(ParticleHandle handle) const {return m_slots[handle.slot].index;}
+
+    /// Handle of the particle stored at an index
+    ParticleHandle getHandle(std::size_t index) const {return {m_slotOfIndex[index], m_slots[m_slotOfIndex[index]].generation};}
+
+    /// Dense storage, for the passes over every particle (don't change its size from the outside)
+    std::vector<Particle>& getParticles() {return m_particles;}
+    const std::vector<Particle>& getParticles() const {return m_particles;}
+
+    Particle& operator[](std::size_t index) {return m_particles[index];}
+    const Particle& operator[](std::size_t index) const {return m_particles[index];}
+    Particle& operator[](ParticleHandle handle) {return m_particles[getIndex(handle)];}
+
+    std::size_t size() const {return m_particles.size();}
+    bool empty() const {return m_particles.empty();}
+    Particle& back() {return m_particles.back();}
+
+    std::vector<Particle>::iterator begin() {return m_particles.begin();}
+    std::vector<Particle>::iterator end() {return m_particles.end();}
+    std::vector<Particle>::const_iterator begin() const {return m_particles.begin();}
+    std::vector<Particle>::const_iterator end() const {return m_particles.end();}
+
+private:
+    struct Slot {
+        std::uint32_t index;        ///< Index of the particle, invalidSlot while the slot is free
+        std::uint32_t generation;   ///< Bumped on every removal
+    };
+
+    std::uint32_t acquireSlot(std::size_t index);
+    void releaseSlot(std::uint32_t slot);
+
+
+    std::vector<Particle> m_particles;
+    std::vector<std::uint32_t> m_slotOfIndex;   ///< Parallel to m_particles
+    std::vector<Slot> m_slots;
+    std::vector<std::uint32_t> m_freeSlots;
+
+    /// permute() buffers, kept between calls to avoid reallocating
+    std::vector<Particle> m_permutedParticles;
+    std::vector<std::uint32_t> m_permutedSlots;
+};
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @class Philox
+ * @brief Philox4x32-10 counter-based random number generator (Salmon et al., Random123)
+ * @details There is no state to advance: the output is a bijection of a 128-bit counter under
+ *          a 64-bit key (the seed). Any draw can be computed independently of the others, so
+ *          particle i can use the counters (i, block) and get the same numbers on any thread.
+ * @author Axel LT
+ * @since 2026-10-19
+ */
+class Philox {
+public:
+    using Block = std::array<std::uint32_t, 4>;
+
+    explicit Philox(std::uint64_t seed) : m_key{static_cast<std::uint32_t>(seed), static_cast<std::uint32_t>(seed >> 32)} {}
+
+    /**
+     * @brief Compute the random block of a counter
+     * @param counter Counter, never reuse one with the same seed
+     * @return Four independent uniform 32-bit words
+     */
+    Block operator()(Block counter) const {
+        std::array<std::uint32_t, 2> key{m_key};
+
+        for (int round = 0; round < 10; ++round) {
+            if (round > 0) {
+                key[0] += 0x9E3779B9u;
+                key[1] += 0xBB67AE85u;
+            }
+
+            const std::uint64_t product0{static_cast<std::uint64_t>(0xD2511F53u) * counter[0]};
+            const std::uint64_t product1{static_cast<std::uint64_t>(0xCD9E8D57u) * counter[2]};
+
+            counter = {static_cast<std::uint32_t>(product1 >> 32) ^ counter[1] ^ key[0], static_cast<std::uint32_t>(product1),
+                       static_cast<std::uint32_t>(product0 >> 32) ^ counter[3] ^ key[1], static_cast<std::uint32_t>(product0)};
+        }
+
+        return counter;
+    }
+
+private:
+    std::array<std::uint32_t, 2> m_key;
+};
+
+/**
+ * @class ParticleRandom
+ * @brief Stream of random numbers owned by one particle
+ * @details The counter is (particle index, block number), so the draws of a particle only
+ *          depend on the seed and its index, never on the thread or on the other particles.
+ */
+class ParticleRandom {
+public:
+    ParticleRandom(const Philox& philox, std::uint64_t index) : m_philox(philox), m_index(index) {}
+
+    /// Uniform in [0, 1)
+    float uniform() {
+        if (m_next == m_values.size()) {
+            m_values = m_philox({static_cast<std::uint32_t>(m_index), static_cast<std::uint32_t>(m_index >> 32), m_block++, 0});
+            m_next = 0;
+        }
+
+        // 24 bits, the float mantissa
+        return static_cast<float>(m_values[m_next++] >> 8) * 0x1.0p-24f;
+    }
+
+    /// Uniform in [min, max)
+    float uniform(float min, float max) {return min + (max - min) * uniform();}
+
+    /// Uniform integer in [min, max]
+    int uniformInt(int min, int max) {
+        const int value{min + static_cast<int>(uniform() * static_cast<float>(max - min + 1))};
+        return value > max ? max : value;
+    }
+
+    /// Standard normal (Box-Muller)
+    float normal() {
+        const float radius{std::sqrt(-2.0f * std::log(1.0f - uniform()))};
+        return radius * std::cos(2.0f * static_cast<float>(M_PI) * uniform());
+    }
+
+private:
+    const Philox& m_philox;
+    std::uint64_t m_index;
+    std::uint32_t m_block{0};
+    Philox::Block m_values{};
+    std::size_t m_next{4};
+};
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @namespace RemoteProtocol
+ * @brief Wire format between the simulation server (StateServer) and the remote viewers (StateClient)
+ * @details Every message is a 4 bytes payload size, a 1 byte MessageType and the payload,
+ *          numbers are sent in the byte order of the machines (both ends are little-endian).
+ *          - hello, server to client once connected: protocol version, map width and height
+ *          - camera, client to server: camera rectangle with Viewport semantics (map pixels)
+ *            and the maximum number of particles the client wants per frame
+ *          - frame, server to client every step: the particles whose disc touches the camera,
+ *            decimated by a hash of their id down to the budget (the same ids are kept from one
+ *            frame to the next), quantized on 16 bits relative to the camera and delta-encoded
+ *            against the previous frame (see encodeFrame)
+ *          The bandwidth depends on what the camera shows, never on the total number of particles.
+ * @note This header does not depend on SDL so that other tools can speak the protocol
+ * @author Axel LT
+ * @since 2026-10-19
+ */
+namespace RemoteProtocol {
+    inline constexpr std::uint16_t defaultPort{47100};
+
+    /// Bumped every time the format below changes
+    inline constexpr std::uint32_t protocolVersion{1};
+
+    enum MessageType : std::uint8_t {
+        hello,
+        camera,
+        frame
+    };
+
+    /// Size of the size and type prefix of every message
+    inline constexpr std::size_t messageHeaderSize{5};
+
+    /// Messages above this size are treated as a corrupted stream
+    inline constexpr std::uint32_t maxMessageSize{64u << 20};
+
+    struct Camera {
+        float x{0.0f};
+        float y{0.0f};
+        float w{1.0f};
+        float h{1.0f};
+
+        bool operator==(const Camera&) const = default;
+    };
+
+    /// Particle as sent in a frame, positions and diameter on the quantization grid of the frame camera
+    struct QuantizedParticle {
+        std::uint64_t id;
+        std::uint16_t x;
+        std::uint16_t y;
+        std::uint16_t diameter;
+    };
+
+    /**
+     * @brief Quantization grid of a camera
+     * @details It spans the camera plus half a camera on each side, so the particles partly
+     *          visible on the borders keep their true center. One step is 2/65535 of the camera width.
+     */
+    struct Grid {
+        float originX;
+        float originY;
+        float step;
+
+        explicit Grid(const Camera& camera) : originX(camera.x - camera.w / 2.0f),
+                                              originY(camera.y - camera.h / 2.0f),
+                                              step(2.0f * camera.w / 65535.0f) {}
+    };
+
+    /// Default particle budget of a client
+    inline constexpr std::uint32_t defaultParticleBudget{20000};
+
+    /**
+     * @brief Check if a particle is kept by the level of detail decimation
+     * @param id Particle id
+     * @param keepFraction Fraction of the particles to keep, in [0, 1]
+     * @return True if the particle is sent
+     */
+    inline bool isKept(std::uint64_t id, double keepFraction) {
+        // splitmix64 finalizer, any id lands uniformly in [0, 1)
+        id += 0x9E3779B97F4A7C15ull;
+        id = (id ^ (id >> 30)) * 0xBF58476D1CE4E5B9ull;
+        id = (id ^ (id >> 27)) * 0x94D049BB133111EBull;
+        id ^= id >> 31;
+
+        return static_cast<double>(id >> 11) * 0x1.0p-53 < keepFraction;
+    }
+
+    /**
+     * @brief Append a frame payload
+     * @details Particles are sorted by id. Each one is written as the varint of its id minus the
+     *          previous id of the frame, then its x, y and diameter: zigzag varints of the change
+     *          since the base frame when the id was in it, plain varints otherwise.
+     * @param base Particles of the previous frame sent to this client, sorted by id
+     * @param particles Particles of this frame, sorted by id
+     * @param bytes Buffer receiving the payload
+     */
+    void encodeParticles(const std::vector<QuantizedParticle>& base, const std::vector<QuantizedParticle>& particles, std::vector<std::uint8_t>& bytes);
+
+    /**
+     * @brief Read a frame payload written by encodeParticles
+     * @param data Start of the particle records
+     * @param size Size of the particle records
+     * @param nbParticles Number of records
+     * @param base Particles of the previous frame received, sorted by id
+     * @param particles Receives the particles of this frame, sorted by id
+     * @return False if the records are corrupted
+     */
+    bool decodeParticles(const std::uint8_t* data, std::size_t size, std::uint32_t nbParticles,
+                         const std::vector<QuantizedParticle>& base, std::vector<QuantizedParticle>& particles);
+
+    /// Append a value of any trivially copyable type
+    template <typename T>
+    void append(std::vector<std::uint8_t>& bytes, const T& value) {
+        const auto* data{reinterpret_cast<const std::uint8_t*>(&value)};
+        bytes.insert(bytes.end(), data, data + sizeof(T));
+    }
+}
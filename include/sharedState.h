@@ -0,0 +1,76 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @namespace SharedState
+ * @brief Layout of the POSIX shared-memory segment holding the live simulation state
+ * @details The segment starts with a Header followed by one float array per field,
+ *          each array holding `capacity` values and starting on a 64 bytes boundary.
+ *          The writer publishes with a seqlock: `sequence` is odd while a step is being
+ *          written and even once it is complete, so readers never block the simulation,
+ *          they retry when the sequence changed during their copy.
+ *          When the particles outgrow the capacity, the writer retires the segment and creates
+ *          a larger one under the same name: readers seeing `retired` must map the name again.
+ * @note This header does not depend on SDL so that external consumers can include it alone
+ * @author Axel LT
+ * @since 2026-10-19
+ */
+namespace SharedState {
+    /// Default name of the segment (see shm_open)
+    inline constexpr char defaultName[]{"/gravity_state"};
+
+    /// "GRVT" in ASCII, written first so readers can reject foreign segments
+    inline constexpr std::uint32_t magic{0x47525654};
+
+    /// Bumped every time the layout below changes
+    inline constexpr std::uint32_t layoutVersion{2};
+
+    /// Arrays exported for each particle, in segment order
+    enum Field : std::uint32_t {
+        centerX,   ///< Center x coordinate (pixels)
+        centerY,   ///< Center y coordinate (pixels)
+        velocityX, ///< Velocity x component (pixels/s)
+        velocityY, ///< Velocity y component (pixels/s)
+        diameter,  ///< Particle diameter (pixels)
+        nbFields
+    };
+
+    struct Header {
+        std::uint32_t magic;
+        std::uint32_t layoutVersion;
+        std::uint32_t capacity;     ///< Number of particles each array can hold
+        std::uint32_t headerSize;   ///< Offset of the first array
+
+        std::atomic<std::uint64_t> sequence; ///< Seqlock counter, odd while the writer is publishing
+        std::atomic<std::uint64_t> step;     ///< Simulation step of the published state
+        std::atomic<std::uint32_t> nbParticles; ///< Number of valid entries in each array
+        std::atomic<std::uint32_t> retired;     ///< Non-zero once the writer left this segment for a new one
+    };
+
+    static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "The seqlock needs lock-free 64 bits atomics to work across processes");
+
+    /// Alignment of the header and of every array
+    inline constexpr std::size_t alignment{64};
+
+    constexpr std::size_t alignUp(std::size_t size) {return (size + alignment - 1) / alignment * alignment;}
+
+    /// Offset of the first array from the start of the segment
+    constexpr std::size_t headerSize() {return alignUp(sizeof(Header));}
+
+    /// Size in bytes of one array
+    constexpr std::size_t arraySize(std::uint32_t capacity) {return alignUp(capacity * sizeof(float));}
+
+    /// Total size in bytes of a segment holding `capacity` particles
+    constexpr std::size_t segmentSize(std::uint32_t capacity) {return headerSize() + nbFields * arraySize(capacity);}
+
+    inline float* array(Header* header, Field field) {
+        return reinterpret_cast<float*>(reinterpret_cast<std::byte*>(header) + header->headerSize + field * arraySize(header->capacity));
+    }
+
+    inline const float* array(const Header* header, Field field) {
+        return reinterpret_cast<const float*>(reinterpret_cast<const std::byte*>(header) + header->headerSize + field * arraySize(header->capacity));
+    }
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "sharedState.h"
+#include "particle.h"
+
+/**
+ * @class SharedStateExporter
+ * @brief Publishes the particles of each step into a POSIX shared-memory segment
+ * @details External tools attach to the segment read-only and copy the arrays
+ *          without ever blocking the simulation (see SharedState for the layout and protocol).
+ * @warning Only one exporter should write to a given segment name
+ * @author Axel LT
+ * @since 2026-10-19
+ */
+class SharedStateExporter {
+public:
+    SharedStateExporter() = default;
+    ~SharedStateExporter() {close();}
+
+    SharedStateExporter(const SharedStateExporter&) = delete;
+    SharedStateExporter& operator=(const SharedStateExporter&) = delete;
+
+    /**
+     * @brief Create (or recreate) the segment and map it
+     * @param name Segment name, must start with a '/'
+     * @param capacity Maximum number of particles exported per step
+     */
+    void open(const char* name, std::uint32_t capacity);
+
+    /**
+     * @brief Retire, unmap and unlink the segment, nothing happens if it is not opened
+     */
+    void close();
+
+    /**
+     * @brief Check if the segment is currently mapped
+     * @return True if publish() can be called
+     */
+    bool isOpen() const {return m_header != nullptr;}
+
+    /**
+     * @brief Get the number of particles the segment can hold
+     * @return Capacity of the segment, 0 if it is not opened
+     */
+    std::uint32_t getCapacity() const {return m_header ? m_header->capacity : 0;}
+
+    /**
+     * @brief Publish the current particles
+     * @details If there are more particles than the capacity, the segment is replaced by a larger one
+     *          (see SharedState::Header::retired), so every particle is always exported.
+     * @param particles Particles of the simulation
+     * @param step Simulation step the particles belong to
+     */
+    void publish(const std::vector<Particle>& particles, std::uint64_t step);
+
+private:
+    /// Name used to unlink the segment
+    std::string m_name;
+
+    /// Start of the mapped segment
+    SharedState::Header* m_header{nullptr};
+
+    /// Size of the mapping in bytes
+    std::size_t m_size{0};
+};
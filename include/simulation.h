@@ -1,11 +1,67 @@
 #pragma once
 
 #include <SDL3/SDL.h>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>
 #include <vector>
 
 #include "map.h"
 #include "viewport.h"
 #include "particle.h"
+#include "particleStore.h"
+#include "sharedStateExporter.h"
+#include "threadPool.h"
+#include "frameRecorder.h"
+#include "asyncFileWriter.h"
+#include "mortonOrder.h"
+#include "neighbourList.h"
+#include "eventDrivenEngine.h"
+#include "continuousCollision.h"
+#include "jobScheduler.h"
+#include "observables.h"
+#include "initialConditions.h"
+#include "stateServer.h"
+#include "stateClient.h"
+#include "historyBuffer.h"
+#include "obstacleField.h"
+#include "frameArena.h"
+#include "sparseGrid.h"
+#include "fastMultipole.h"
+
+/**
+ * @brief Integrator used to move the particles
+ */
+enum class PhysicsEngine {
+    timeStepped, ///< Move by deltaTime then solve the interactions (any PairInteraction)
+    eventDriven  ///< Exact hard-disc dynamics, see EventDrivenEngine
+};
+
+/**
+ * @brief Parameters of a headless Simulation
+ * @see EnsembleRunner
+ */
+struct SimulationSettings {
+    int nbParticles{100};
+    int minMass{static_cast<int>(0.01f * Particle::sharedParticleMass)};
+    int maxMass{static_cast<int>(0.1f * Particle::sharedParticleMass)};
+    float maxSpeed{5000.0f};        ///< Spawn speeds are uniform in [0, maxSpeed] (px/s)
+    float restitution{1.0f};        ///< Coefficient of restitution of the hard-sphere collisions
+    PairInteraction pairInteraction{PairInteraction::hardSphere};
+    std::uint64_t seed{0};          ///< Seed of the spawn generator
+    unsigned nbThreads{1};          ///< Threads of the instance, 0 for one per core
+    std::string obstacleBitmap;     ///< BMP of the solid map squares (dark pixels), empty for none
+    bool unbounded{false};          ///< The particles can leave the map, see Map::setUnbounded
+    bool gravity{false};            ///< Long-range gravity between all the particles, see FastMultipole
+    float gravitationalConstant{1.0e3f};
+    int multipoleOrder{16};
+    std::optional<InitialCondition> initialCondition; ///< Generated population (see InitialConditions), none for the random spawn
+    std::string sharedStateName;    ///< Segment the state of each step is exported to (see SharedState), empty for none
+    std::string framesDirectory;    ///< Directory runHeadless records the frames to (see FrameRecorder), empty for none
+    int recordInterval{1};          ///< Steps between two recorded frames
+    SDL_FRect camera{};             ///< Recorded portion of the map (Viewport semantics), an empty one fits the whole map
+};
 
 /**
  * @class Simulation
@@ -24,6 +80,16 @@ public:
      */
     Simulation(const char* appName, const char* creatorName);
 
+    /**
+     * @brief Construct a headless Simulation object
+     * @details No window, renderer nor ImGui context, SDL isn't even initialised,
+     *          so many instances can live in the same process (see EnsembleRunner).
+     *          The front end tools aren't built either: no file writer thread, offline
+     *          renderer nor shared-state exporter, unless the settings ask for them.
+     * @param settings Population, spawn and collision parameters
+     */
+    explicit Simulation(const SimulationSettings& settings);
+
     /**
      * @brief Destroy the Simulation object and clean up resources
      */
@@ -50,31 +116,200 @@ public:
      */
     void run();
 
-private:
-    float getTotalKineticEnergy();
+    /**
+     * @brief Run a fixed number of physics steps without events nor rendering
+     * @details Each step is published to the shared-state segment if one is open,
+     *          and every SimulationSettings::recordInterval steps a frame is recorded if asked.
+     * @param nbSteps Number of steps
+     * @param deltaTime Physics time of a step (s)
+     */
+    void runHeadless(int nbSteps, float deltaTime);
+
+    /**
+     * @brief Run the physics in real time and stream it to the remote viewers, never returns
+     * @details Meant for a headless Simulation, one step of 1/targetFPS per frame.
+     * @param port TCP port the viewers connect to
+     * @see StateServer
+     */
+    void runServer(std::uint16_t port);
+
+    /**
+     * @brief Turn this Simulation into a thin client of a remote one
+     * @details The local particles are dropped, run() then only moves the viewport,
+     *          sends it as the camera and renders the received particles.
+     * @param host Name or address of the server
+     * @param port TCP port of the server
+     * @see StateClient
+     */
+    void connectToServer(const std::string& host, std::uint16_t port);
+
+    /**
+     * @brief Count the heap allocations of warmed-up physics steps
+     * @details Each step does the work of a frame of run() without events nor rendering: frame arena
+     *          reset, physics step and history record (with a small budget so that it wraps during
+     *          the warm-up). Meant for a headless Simulation built with GRAVITY_TRACK_ALLOCATIONS.
+     * @param nbWarmupSteps Steps run before counting
+     * @param nbSteps Steps counted
+     * @param deltaTime Physics time of a step (s)
+     * @return Number of operator new calls during the counted steps, always 0 without GRAVITY_TRACK_ALLOCATIONS
+     */
+    std::uint64_t countSteadyStateAllocations(int nbWarmupSteps, int nbSteps, float deltaTime);
+
+    const Observables& getObservables() const {return m_observables;}
 
+private:
     void destroyParticles(int nbParticles);
     void spawnParticles(int nbParticles);
+    void requestParticles();
+    void generateInitialConditions();
+    void saveCheckpoint();
+    void loadCheckpoint();
+    void restoreHistory(std::uint64_t step);
+    void paintObstacles();
+    void loadObstacles();
+    void setUnbounded(bool unbounded);
+    void reorderParticles();
     void myImGuiWindow();
+    void observablesImGui();
+    void remoteImGui();
+    void historyImGui();
+    void obstaclesImGui();
+    void allocationsImGui();
+    void gravityImGui();
     void handleEvents(SDL_Event &event, bool &running);
     void handleZoom(SDL_Event &event);
     void handleMovements(const bool *keys, float deltaTime);
+    void stepParticles(float deltaTime);
+    void stepTimeStepped(float deltaTime);
+    void stepEventDriven(float deltaTime);
+    void mergeParticles();
     void render();
+    void renderSpaceBackground();
 
 
     SDL_Window* m_window{nullptr};
     SDL_Renderer* m_renderer{nullptr};
+    bool m_headless{false};
 
     Map m_map;
     Viewport m_viewport;
-    std::vector<Particle> m_particles;
+    ParticleStore m_particles;
+
+    std::uint64_t m_step{0};
+    std::optional<SharedStateExporter> m_sharedStateExporter;
+    bool m_exportSharedState{false};
+
+    // Remote viewing, see RemoteProtocol
+    StateServer m_stateServer;
+    StateClient m_stateClient;
+    int m_remoteParticleBudget{static_cast<int>(RemoteProtocol::defaultParticleBudget)};
+    static constexpr int maxRemoteParticleBudget{1000000};
+
+    ThreadPool m_threadPool;
+    Observables m_observables;
+
+    /// Frames and checkpoints are written on this thread, only with a window
+    std::optional<AsyncFileWriter> m_fileWriter;
+
+    // Maintenance work spread over several frames
+    JobScheduler m_jobScheduler;
+    float m_jobBudgetMs{4.0f};
+    std::string m_lastCheckpoint;
+    std::uint64_t m_lastCheckpointTicket{0};
+
+    // In-memory rewind, the physics is frozen on a past step while scrubbing
+    HistoryBuffer m_history;
+    bool m_recordHistory{false};
+    bool m_historyScrubbing{false};
+    std::uint64_t m_scrubStep{0};
+    static constexpr int maxHistoryBudgetMB{8192};
+    static constexpr std::size_t allocationCheckHistoryBudget{std::size_t{256} << 10};
+    static constexpr const char* populationJobName{"Spawning/destroying particles"};
+
+    /// Scratch memory of the frame loop (render batches), rewound at each frame boundary
+    FrameArena m_frameArena;
+    static constexpr std::size_t discBatchSize{4096};
+
+    // Offline movie recording, rendered off the frame path by the recorder thread
+    std::optional<FrameRecorder> m_frameRecorder;
+    bool m_recordFrames{false};
+    int m_recordInterval{1};
+    SDL_FRect m_recordingCamera{};
+    static constexpr const char* defaultFramesDirectory{"frames"};
+    static constexpr int recordingWidth{3840};
+
+    // Periodic Morton reordering of m_particles, 0 disables it
+    MortonOrder m_mortonOrder;
+    int m_reorderInterval{500};
+    float m_reorderMs{0.0f};
+    float m_physicsPassMs{0.0f};
+    float m_physicsPassMsBeforeReorder{0.0f};
+    static constexpr int maxReorderInterval{5000};
+
+    // Solid map squares, painted with the mouse or loaded from a bitmap
+    ObstacleField m_obstacleField;
+    bool m_paintObstacles{false};
+    bool m_obstaclesChanged{false};
+    char m_obstacleBitmap[256]{"obstacles.bmp"};
+    static constexpr const char* obstacleJobName{"Building obstacle distance field"};
+    static constexpr std::size_t obstacleLinesPerSlice{64};
+
+    /// Occupied cells of an unbounded map, for the culling and the background
+    SparseGrid m_spaceGrid;
+    static constexpr int squaresPerSpaceCell{8};
+
+    // Long-range gravity, only used by the time-stepped engine
+    FastMultipole m_fastMultipole;
+    bool m_gravity{false};
+    float m_gravitationalConstant{1.0e3f};
+    float m_gravityMs{0.0f};
+    MultipoleError m_multipoleError;
+    static constexpr std::size_t multipoleErrorSamples{200};
+
+    // Short-range interactions
+    NeighbourList m_neighbourList;
+    PairInteraction m_pairInteraction{PairInteraction::hardSphere};
+    float m_pairStrength{1.0e6f};
+
+    /// Touching pairs found during a step with PairInteraction::merging, merged at the end of the step
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> m_mergingPairs;
+    std::vector<std::uint8_t> m_absorbed;
+    std::uint64_t m_nbMerges{0};
+
+    PhysicsEngine m_physicsEngine{PhysicsEngine::timeStepped};
+    EventDrivenEngine m_eventDrivenEngine;
+    bool m_eventDrivenEngineLoaded{false};
+
+    ContinuousCollision m_continuousCollision;
+    bool m_sweptCollisions{true};
+
+    // Spawn and collision parameters, see SimulationSettings
+    /// The draws of the i-th spawned particle only depend on (m_seed, i), see ParticleRandom
+    std::uint64_t m_seed{0};
+    int m_minMass{static_cast<int>(0.01f * Particle::sharedParticleMass)};
+    int m_maxMass{static_cast<int>(0.1f * Particle::sharedParticleMass)};
+    float m_maxSpeed{5000.0f};
+    float m_restitution{1.0f};
+
+    // Generated initial conditions, replacing all the particles
+    InitialConditions m_initialConditions;
+    std::vector<Particle> m_generatedParticles;
+    static constexpr std::size_t initialConditionsChunk{1 << 16};
+    InitialConditionSettings m_initialConditionSettings;
+    static constexpr int maxGeneratedParticles{10000000};
+
+    /// Physics deltaTime is the frame time multiplied by this factor
+    float m_timeScale{1.0f};
+    static constexpr float maxTimeScale{10.0f};
 
     int nbParticlesSim{0};
     int nbParticlesWantedSim{3};
     static constexpr int maxNBParticlesSim{1000};
+    static constexpr int maxSpawnAttempts{1000};
 
     static constexpr float targetFPS{120.0f};
     static constexpr float screenHeight{800.0f};
     static constexpr float screenWidth{1200.0f};
     static constexpr float screenRatio{screenWidth/screenHeight};
+    static constexpr int recordingHeight{static_cast<int>(recordingWidth / screenRatio)};
 };
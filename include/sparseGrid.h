@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "particle.h"
+
+/**
+ * @class SparseGrid
+ * @brief Square cells of unbounded space, only the occupied ones exist
+ * @details Cells are keyed by their (column, row), any integer, in an open-addressing hash table.
+ *          build() bins the particle centers: a cell exists while a particle center is in it, so
+ *          the cells follow the particles and the memory scales with the occupied area, not with
+ *          the bounding box of the particles (escaping bodies only add their own cells).
+ *          The particles are stored sorted by cell: the particles of a cell are
+ *          getParticles()[cell.begin] to getParticles()[cell.end - 1].
+ * @warning Like the neighbour lists, the cells refer to particle indices, rebuild after any change
+ * @author Axel LT
+ * @since 2026-10-19
+ */
+class SparseGrid {
+public:
+    struct Cell {
+        int column;
+        int row;
+        std::uint32_t begin;
+        std::uint32_t end;
+    };
+
+    /**
+     * @brief Bin the particles into the cells, the previous cells are dropped
+     * @param particles Particles to bin, by their center
+     * @param cellSize Side of a cell (px)
+     */
+    void build(const std::vector<Particle>& particles, float cellSize);
+
+    /**
+     * @brief Find an occupied cell
+     * @param column Column of the cell, floor(x / cellSize)
+     * @param row Row of the cell, floor(y / cellSize)
+     * @return The cell, nullptr if no particle is in it
+     */
+    const Cell* findCell(int column, int row) const;
+
+    int getColumn(float x) const {return getCoordinate(x);}
+    int getRow(float y) const {return getCoordinate(y);}
+    float getCellSize() const {return m_cellSize;}
+
+    const std::vector<Cell>& getCells() const {return m_cells;}
+    const std::vector<std::uint32_t>& getParticles() const {return m_particles;}
+
+    /// Cell of a particle, index in getCells()
+    std::uint32_t getParticleCell(std::size_t particle) const {return m_particleCells[particle];}
+
+    /// Largest radius of the binned particles, how far a disc can reach out of its cell (px)
+    float getMaxRadius() const {return m_maxRadius;}
+
+    /// Bytes held by the cells and the hash table
+    std::size_t getMemoryUsage() const {return m_cells.capacity() * sizeof(Cell) + m_table.capacity() * sizeof(std::uint32_t);}
+
+private:
+    int getCoordinate(float position) const;
+    std::size_t getSlot(int column, int row) const;
+    std::uint32_t findOrInsert(int column, int row);
+    void resizeTable(std::size_t nbSlots);
+
+
+    float m_cellSize{1.0f};
+    float m_maxRadius{0.0f};
+
+    std::vector<Cell> m_cells;
+
+    /// Open addressing with linear probing, indices in m_cells, at most half full
+    std::vector<std::uint32_t> m_table;
+    std::size_t m_tableMask{0};
+
+    std::vector<std::uint32_t> m_particleCells;
+    std::vector<std::uint32_t> m_particles;
+
+    static constexpr std::uint32_t emptySlot{0xFFFFFFFFu};
+    static constexpr std::size_t minNbSlots{64};
+};
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <SDL3/SDL.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "remoteProtocol.h"
+
+/**
+ * @class StateClient
+ * @brief Remote viewer side of RemoteProtocol, receives the particles seen by a camera from a StateServer
+ * @details Only connect() blocks (until the hello of the server is read), sendCamera() and receive()
+ *          are meant to be called once per rendered frame.
+ * @author Axel LT
+ * @since 2026-10-19
+ */
+class StateClient {
+public:
+    StateClient() = default;
+    ~StateClient() {disconnect();}
+
+    StateClient(const StateClient&) = delete;
+    StateClient& operator=(const StateClient&) = delete;
+
+    /**
+     * @brief Connect to a server and read its hello
+     * @param host Name or address of the server
+     * @param port TCP port of the server
+     * @throws RemoteError If the server can't be reached or speaks another protocol version
+     */
+    void connect(const std::string& host, std::uint16_t port);
+
+    /**
+     * @brief Close the connection, nothing happens if it is not connected
+     */
+    void disconnect();
+
+    bool isConnected() const {return m_socket != -1;}
+
+    /**
+     * @brief Ask the server for another camera, nothing is sent if neither argument changed
+     * @param camera Rectangle of the map to receive, with Viewport semantics
+     * @param particleBudget Maximum number of particles per frame
+     */
+    void sendCamera(const RemoteProtocol::Camera& camera, std::uint32_t particleBudget);
+
+    /**
+     * @brief Read every frame already received, only the last one is kept
+     * @return True if a new frame arrived
+     * @throws RemoteError If the server closed the connection or sent a corrupted frame
+     */
+    bool receive();
+
+    float getMapWidth() const {return m_mapWidth;}
+    float getMapHeight() const {return m_mapHeight;}
+
+    /// Particles of the last frame, sorted by id
+    const std::vector<RemoteProtocol::QuantizedParticle>& getParticles() const {return m_particles;}
+
+    /**
+     * @brief Get the map rectangle of a particle of the last frame
+     * @param particle One of getParticles()
+     * @return Same rectangle as Particle::getParticle, up to the quantization
+     */
+    SDL_FRect getDisc(const RemoteProtocol::QuantizedParticle& particle) const;
+
+    /// Statistics of the last frame
+    std::uint64_t getStep() const {return m_step;}
+    std::uint32_t getNbVisible() const {return m_nbVisible;}
+    std::size_t getLastFrameBytes() const {return m_lastFrameBytes;}
+    std::uint64_t getNbBytesReceived() const {return m_nbBytesReceived;}
+
+private:
+    void flush();
+    void readFrame(const std::uint8_t* payload, std::size_t size);
+
+
+    int m_socket{-1};
+    float m_mapWidth{0.0f};
+    float m_mapHeight{0.0f};
+
+    std::vector<std::uint8_t> m_input;
+    std::vector<std::uint8_t> m_output;
+
+    bool m_hasCamera{false};
+    RemoteProtocol::Camera m_camera;
+    std::uint32_t m_particleBudget{RemoteProtocol::defaultParticleBudget};
+
+    /// Camera of the last frame, it may lag behind m_camera by the network round trip
+    RemoteProtocol::Camera m_frameCamera;
+    std::vector<RemoteProtocol::QuantizedParticle> m_particles;
+    std::vector<RemoteProtocol::QuantizedParticle> m_decodedParticles;
+
+    std::uint64_t m_step{0};
+    std::uint32_t m_nbVisible{0};
+    std::size_t m_lastFrameBytes{0};
+    std::uint64_t m_nbBytesReceived{0};
+};
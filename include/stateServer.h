@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "remoteProtocol.h"
+#include "map.h"
+#include "particleStore.h"
+
+/**
+ * @class StateServer
+ * @brief Streams the particles seen by each remote viewer over TCP, see RemoteProtocol
+ * @details Everything is non-blocking and runs from the simulation loop: publish() accepts the
+ *          new viewers, reads their camera requests, then encodes one frame per viewer.
+ *          A viewer whose previous frame is still in the socket (slow network) skips frames,
+ *          the delta base is always the last frame fully handed to the socket so it stays in sync.
+ * @author Axel LT
+ * @since 2026-10-19
+ */
+class StateServer {
+public:
+    StateServer() = default;
+    ~StateServer() {close();}
+
+    StateServer(const StateServer&) = delete;
+    StateServer& operator=(const StateServer&) = delete;
+
+    /**
+     * @brief Listen for viewers
+     * @param port TCP port
+     * @param map Map of the simulation, sent to the viewers
+     */
+    void open(std::uint16_t port, const Map& map);
+
+    /**
+     * @brief Disconnect every viewer and stop listening, nothing happens if it is not opened
+     */
+    void close();
+
+    bool isOpen() const {return m_listenSocket != -1;}
+
+    /**
+     * @brief Send the current step to every viewer that asked for a camera
+     * @param particles Particles of the simulation
+     * @param step Simulation step
+     */
+    void publish(const ParticleStore& particles, std::uint64_t step);
+
+    /// Statistics
+    std::size_t getNbClients() const {return m_clients.size();}
+    std::size_t getLastFrameBytes() const {return m_lastFrameBytes;}
+    std::uint64_t getNbBytesSent() const {return m_nbBytesSent;}
+
+private:
+    struct Client {
+        int socket{-1};
+        bool hasCamera{false};
+        RemoteProtocol::Camera camera;
+        std::uint32_t particleBudget{RemoteProtocol::defaultParticleBudget};
+
+        std::vector<std::uint8_t> input;
+        std::vector<std::uint8_t> output;
+        std::size_t outputOffset{0};
+
+        /// Last frame handed to the socket, delta base of the next one
+        std::vector<RemoteProtocol::QuantizedParticle> base;
+    };
+
+    void acceptClients();
+    bool receive(Client& client);
+    bool flush(Client& client);
+    void encodeFrame(Client& client, const ParticleStore& particles, std::uint64_t step);
+
+
+    int m_listenSocket{-1};
+    float m_mapWidth{0.0f};
+    float m_mapHeight{0.0f};
+
+    std::vector<Client> m_clients;
+
+    /// Scratch buffer of the frame being encoded
+    std::vector<RemoteProtocol::QuantizedParticle> m_visible;
+
+    std::size_t m_lastFrameBytes{0};
+    std::uint64_t m_nbBytesSent{0};
+};
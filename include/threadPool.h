@@ -0,0 +1,85 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @class ThreadPool
+ * @brief Fixed set of worker threads used to split loops over particles, tiles, cells...
+ * @details The calling thread takes part in the work, so a pool of 1 thread runs everything inline.
+ *          The range is cut in one contiguous chunk per thread, chunk k always goes to thread k
+ *          so that per-thread partial results can be combined in a deterministic order.
+ * @warning parallelFor is not reentrant, don't call it from inside a parallelFor
+ * @author Axel LT
+ * @since 2026-10-19
+ */
+class ThreadPool {
+public:
+    /**
+     * @brief Start the workers
+     * @param nbThreads Number of threads including the caller, 0 means one per hardware thread
+     */
+    explicit ThreadPool(unsigned nbThreads = 0);
+
+    /**
+     * @brief Stop and join the workers
+     */
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * @brief Get the number of threads taking part in parallelFor (workers + caller)
+     * @return Number of threads
+     */
+    unsigned getNbThreads() const {return static_cast<unsigned>(m_workers.size()) + 1;}
+
+    /**
+     * @brief Run function(begin, end, threadIndex) over [0, count) split between the threads
+     * @details Blocks until every chunk is done, the first exception thrown by a chunk is rethrown here.
+     *          No allocation happens, the callable is only referenced during the call.
+     * @param count Size of the range
+     * @param function Callable taking (std::size_t begin, std::size_t end, unsigned threadIndex)
+     */
+    template <typename Function>
+    void parallelFor(std::size_t count, Function&& function) {
+        using Callable = std::remove_reference_t<Function>;
+
+        dispatch(count, const_cast<void*>(static_cast<const void*>(&function)),
+                 [](void* context, std::size_t begin, std::size_t end, unsigned threadIndex) {
+                     (*static_cast<Callable*>(context))(begin, end, threadIndex);
+                 });
+    }
+
+private:
+    using Invoker = void (*)(void*, std::size_t, std::size_t, unsigned);
+
+    void dispatch(std::size_t count, void* context, Invoker invoker);
+    void runChunk(unsigned threadIndex);
+    void workerLoop(unsigned threadIndex);
+
+
+    std::vector<std::thread> m_workers;
+
+    std::mutex m_mutex;
+    std::condition_variable m_wakeWorkers;
+    std::condition_variable m_chunksDone;
+
+    /// Current job, only valid while a parallelFor is running
+    void* m_context{nullptr};
+    Invoker m_invoker{nullptr};
+    std::size_t m_count{0};
+
+    /// Incremented for each job so that workers know there is something new to do
+    std::size_t m_generation{0};
+    unsigned m_remainingChunks{0};
+    bool m_stopping{false};
+
+    std::exception_ptr m_exception;
+};
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * @namespace Varint
+ * @brief LEB128 variable-length integers, the smaller the value the fewer bytes (7 bits per byte)
+ * @details Signed changes go through zigzag() first so that small negative values stay small.
+ *          Used by RemoteProtocol and HistoryBuffer.
+ * @author Axel LT
+ * @since 2026-10-19
+ */
+namespace Varint {
+    inline void append(std::vector<std::uint8_t>& bytes, std::uint64_t value) {
+        while (value >= 0x80) {
+            bytes.push_back(static_cast<std::uint8_t>(value) | 0x80);
+            value >>= 7;
+        }
+
+        bytes.push_back(static_cast<std::uint8_t>(value));
+    }
+
+    /**
+     * @brief Read a varint
+     * @param data Read position, advanced past the varint
+     * @param end End of the buffer
+     * @param value Receives the value
+     * @return False if the buffer ends in the middle of the varint or the varint is too long
+     */
+    inline bool read(const std::uint8_t*& data, const std::uint8_t* end, std::uint64_t& value) {
+        value = 0;
+
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (data == end) {
+                return false;
+            }
+
+            const std::uint8_t byte{*data++};
+            value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+
+            if (!(byte & 0x80)) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    /// Small changes of either sign become small unsigned values
+    inline std::uint32_t zigzag(std::int32_t value) {return (static_cast<std::uint32_t>(value) << 1) ^ static_cast<std::uint32_t>(value >> 31);}
+    inline std::int32_t unzigzag(std::uint32_t value) {return static_cast<std::int32_t>(value >> 1) ^ -static_cast<std::int32_t>(value & 1);}
+}
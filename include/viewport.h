@@ -9,7 +9,7 @@
  * @brief Represents the visible portion of the map
  * @details The Viewport defines which part of the Map is currently visible
  *          on the screen. It supports movement and zooming while ensuring
- *          that it stays within the map boundaries.
+ *          that it stays within the map boundaries, unless the map is unbounded.
  * @author Axel LT
  * @since 2026-02-17
  */
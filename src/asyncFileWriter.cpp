@@ -0,0 +1,110 @@
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "asyncFileWriter.h"
+
+AsyncFileWriter::AsyncFileWriter(std::size_t maxPending) : m_maxPending(maxPending) {
+    m_writer = std::thread(&AsyncFileWriter::writerLoop, this);
+}
+
+AsyncFileWriter::~AsyncFileWriter() {
+    {
+        std::lock_guard lock(m_mutex);
+        m_stopping = true;
+    }
+    m_hasWork.notify_one();
+
+    m_writer.join();
+}
+
+std::vector<std::uint8_t> AsyncFileWriter::acquireBuffer() {
+    std::lock_guard lock(m_mutex);
+
+    if (m_freeBuffers.empty()) {
+        return {};
+    }
+
+    std::vector<std::uint8_t> buffer{std::move(m_freeBuffers.back())};
+    m_freeBuffers.pop_back();
+    buffer.clear();
+
+    return buffer;
+}
+
+std::uint64_t AsyncFileWriter::push(std::string path, std::vector<std::uint8_t>&& bytes) {
+    std::uint64_t ticket;
+
+    {
+        std::unique_lock lock(m_mutex);
+        m_hasRoom.wait(lock, [this] {return m_pending.size() < m_maxPending;});
+
+        ticket = ++m_lastTicket;
+        m_pending.push_back({ticket, std::move(path), std::move(bytes)});
+    }
+    m_hasWork.notify_one();
+
+    return ticket;
+}
+
+std::size_t AsyncFileWriter::getNbPending() {
+    std::lock_guard lock(m_mutex);
+    return static_cast<std::size_t>(m_lastTicket - m_lastWrittenTicket);
+}
+
+WriteStatus AsyncFileWriter::getStatus(std::uint64_t ticket) {
+    std::lock_guard lock(m_mutex);
+
+    if (ticket > m_lastWrittenTicket) {
+        return WriteStatus::pending;
+    }
+
+    const bool failed{std::find(m_failedTickets.begin(), m_failedTickets.end(), ticket) != m_failedTickets.end()};
+    return failed ? WriteStatus::failed : WriteStatus::written;
+}
+
+std::size_t AsyncFileWriter::getNbFailures() {
+    std::lock_guard lock(m_mutex);
+    return m_nbFailures;
+}
+
+void AsyncFileWriter::writerLoop() {
+    while (true) {
+        PendingFile file;
+
+        {
+            std::unique_lock lock(m_mutex);
+            m_hasWork.wait(lock, [this] {return m_stopping || !m_pending.empty();});
+
+            // We still write what is pending when stopping, nothing is lost
+            if (m_pending.empty()) {
+                return;
+            }
+
+            file = std::move(m_pending.front());
+            m_pending.pop_front();
+        }
+        m_hasRoom.notify_one();
+
+        // Closed before the ticket is marked written, so a reader never sees the file half-written
+        bool failed;
+        {
+            std::ofstream stream(file.path, std::ios::binary | std::ios::trunc);
+            stream.write(reinterpret_cast<const char*>(file.bytes.data()), static_cast<std::streamsize>(file.bytes.size()));
+            stream.close();
+            failed = !stream;
+        }
+
+        std::lock_guard lock(m_mutex);
+        if (failed) {
+            ++m_nbFailures;
+            m_failedTickets.push_back(file.ticket);
+        }
+        m_lastWrittenTicket = file.ticket;
+        m_freeBuffers.push_back(std::move(file.bytes));
+    }
+}
@@ -0,0 +1,92 @@
+#include <SDL3/SDL.h>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <vector>
+#include "Eigen/Dense"
+
+#include "checkpoint.h"
+#include "checkpointErrors.h"
+#include "map.h"
+#include "particle.h"
+
+namespace {
+    constexpr char magic[4]{'G', 'R', 'V', 'C'};
+    constexpr std::uint32_t formatVersion{1};
+
+    struct Header {
+        char magic[4];
+        std::uint32_t formatVersion;
+        std::uint64_t step;
+        std::uint32_t nbParticles;
+        std::uint32_t reserved;
+    };
+
+    struct Record {
+        std::int32_t mass;
+        float x;
+        float y;
+        float velocityX;
+        float velocityY;
+    };
+}
+
+void Checkpoint::encode(const std::vector<Particle>& particles, std::uint64_t step, std::vector<std::uint8_t>& bytes) {
+    Header header{};
+    std::memcpy(header.magic, magic, sizeof(magic));
+    header.formatVersion = formatVersion;
+    header.step = step;
+    header.nbParticles = static_cast<std::uint32_t>(particles.size());
+
+    bytes.resize(sizeof(Header) + particles.size() * sizeof(Record));
+    std::memcpy(bytes.data(), &header, sizeof(Header));
+
+    std::uint8_t* output{bytes.data() + sizeof(Header)};
+
+    for (const Particle& particle : particles) {
+        const SDL_FRect rect{particle.getParticle()};
+        const Eigen::Vector2f velocity{particle.getVelocity()};
+        const Record record{particle.getMass(), rect.x, rect.y, velocity(0), velocity(1)};
+
+        std::memcpy(output, &record, sizeof(Record));
+        output += sizeof(Record);
+    }
+}
+
+std::uint64_t Checkpoint::load(const char* path, const Map& map, std::vector<Particle>& particles) {
+    std::ifstream stream(path, std::ios::binary);
+
+    if (!stream) {
+        throw CheckpointError("Opening the checkpoint failed: ", path);
+    }
+
+    const std::vector<char> bytes{std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>()};
+
+    Header header{};
+    if (bytes.size() < sizeof(Header)) {
+        throw CheckpointError("The checkpoint is truncated: ", path);
+    }
+    std::memcpy(&header, bytes.data(), sizeof(Header));
+
+    if (std::memcmp(header.magic, magic, sizeof(magic)) != 0 || header.formatVersion != formatVersion) {
+        throw CheckpointError("The file is not a checkpoint of this version: ", path);
+    }
+
+    if (bytes.size() < sizeof(Header) + header.nbParticles * sizeof(Record)) {
+        throw CheckpointError("The checkpoint is truncated: ", path);
+    }
+
+    particles.clear();
+    const char* input{bytes.data() + sizeof(Header)};
+
+    for (std::uint32_t i = 0; i < header.nbParticles; ++i) {
+        Record record;
+        std::memcpy(&record, input, sizeof(Record));
+        input += sizeof(Record);
+
+        particles.emplace_back(record.mass, Eigen::Vector2f{record.velocityX, record.velocityY});
+        particles.back().setCoordinates(map, record.x, record.y);
+    }
+
+    return header.step;
+}
@@ -0,0 +1,234 @@
+#include <SDL3/SDL.h>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "Eigen/Dense"
+
+#include "continuousCollision.h"
+#include "map.h"
+#include "obstacleField.h"
+#include "particle.h"
+#include "sparseGrid.h"
+
+void ContinuousCollision::advance(std::vector<Particle>& particles, const Map& map, const ObstacleField& obstacles, const float deltaTime) {
+    const std::size_t nbParticles{particles.size()};
+    const float speedThresholdSquared{m_speedThreshold * m_speedThreshold};
+
+    m_fast.assign(nbParticles, 0);
+    m_advanced.assign(nbParticles, 0);
+    m_impacts.clear();
+    m_nbFastParticles = 0;
+    m_nbImpacts = 0;
+
+    float maxSlowRadius{0.0f};
+
+    for (std::size_t i = 0; i < nbParticles; ++i) {
+        if (particles[i].getVelocity().squaredNorm() > speedThresholdSquared) {
+            m_fast[i] = 1;
+            ++m_nbFastParticles;
+        } else {
+            maxSlowRadius = std::max(maxSlowRadius, particles[i].getParticle().w / 2.0f);
+        }
+    }
+
+    if (m_nbFastParticles == 0) {
+        return;
+    }
+
+    // Broad phase between fast particles: sort and sweep of their swept boxes only
+    m_boxes.clear();
+
+    for (std::size_t i = 0; i < nbParticles; ++i) {
+        if (m_fast[i]) {
+            m_boxes.push_back(sweptBox(particles[i], static_cast<std::uint32_t>(i), deltaTime));
+        }
+    }
+
+    std::sort(m_boxes.begin(), m_boxes.end(), [](const SweptBox& a, const SweptBox& b) {return a.minX < b.minX;});
+
+    // Sort and sweep along x, m_active holds the boxes still overlapping the current x
+    m_active.clear();
+
+    for (std::uint32_t k = 0; k < m_boxes.size(); ++k) {
+        const SweptBox& box{m_boxes[k]};
+
+        for (std::size_t a = 0; a < m_active.size();) {
+            const SweptBox& activeBox{m_boxes[m_active[a]]};
+
+            if (activeBox.maxX < box.minX) {
+                m_active[a] = m_active.back();
+                m_active.pop_back();
+                continue;
+            }
+
+            if (activeBox.minY <= box.maxY && box.minY <= activeBox.maxY) {
+                addPairImpact(particles, activeBox.index, box.index, deltaTime);
+            }
+
+            ++a;
+        }
+
+        m_active.push_back(k);
+    }
+
+    // Broad phase between fast and slow particles: the slow ones are only binned by their center.
+    // A slow swept box reaches at most maxSlowRadius + speedThreshold * deltaTime out of its center
+    const float slowReach{maxSlowRadius + m_speedThreshold * deltaTime};
+    m_grid.build(particles, std::max(2.0f * slowReach, 1.0f));
+
+    for (const SweptBox& box : m_boxes) {
+        const int minColumn{m_grid.getColumn(box.minX - slowReach)};
+        const int maxColumn{m_grid.getColumn(box.maxX + slowReach)};
+        const int minRow{m_grid.getRow(box.minY - slowReach)};
+        const int maxRow{m_grid.getRow(box.maxY + slowReach)};
+
+        auto visitCell = [&](const SparseGrid::Cell& cell) {
+            for (std::uint32_t k = cell.begin; k < cell.end; ++k) {
+                const std::uint32_t other{m_grid.getParticles()[k]};
+
+                if (m_fast[other]) {
+                    continue;
+                }
+
+                const SweptBox otherBox{sweptBox(particles[other], other, deltaTime)};
+
+                if (otherBox.minX <= box.maxX && box.minX <= otherBox.maxX && otherBox.minY <= box.maxY && box.minY <= otherBox.maxY) {
+                    addPairImpact(particles, box.index, other, deltaTime);
+                }
+            }
+        };
+
+        // A very long sweep covers more cells than exist, then scanning the occupied ones is cheaper
+        const double nbCoveredCells{(static_cast<double>(maxColumn) - minColumn + 1.0) * (static_cast<double>(maxRow) - minRow + 1.0)};
+
+        if (nbCoveredCells > static_cast<double>(m_grid.getCells().size())) {
+            for (const SparseGrid::Cell& cell : m_grid.getCells()) {
+                if (cell.column >= minColumn && cell.column <= maxColumn && cell.row >= minRow && cell.row <= maxRow) {
+                    visitCell(cell);
+                }
+            }
+        } else {
+            for (int row = minRow; row <= maxRow; ++row) {
+                for (int column = minColumn; column <= maxColumn; ++column) {
+                    if (const SparseGrid::Cell* cell{m_grid.findCell(column, row)}) {
+                        visitCell(*cell);
+                    }
+                }
+            }
+        }
+    }
+
+    // No walls to hit in an unbounded map
+    for (std::size_t i = 0; i < nbParticles && !map.isUnbounded(); ++i) {
+        if (m_fast[i]) {
+            addWallImpacts(particles[i], static_cast<std::uint32_t>(i), map, deltaTime);
+        }
+    }
+
+    // Narrow phase done, each particle only takes its first impact of the step
+    std::sort(m_impacts.begin(), m_impacts.end(), [](const Impact& a, const Impact& b) {return a.time < b.time;});
+
+    for (const Impact& impact : m_impacts) {
+        const bool isWall{impact.otherParticle == noParticle};
+
+        if (m_advanced[impact.particle] || (!isWall && m_advanced[impact.otherParticle])) {
+            continue;
+        }
+
+        ++m_nbImpacts;
+        Particle& particle{particles[impact.particle]};
+        moveParticle(particle, map, obstacles, impact.time);
+
+        if (isWall) {
+            Eigen::Vector2f velocity{particle.getVelocity()};
+            velocity(impact.axis) = -velocity(impact.axis);
+            particle.setVelocity(velocity);
+        }
+        else {
+            Particle& otherParticle{particles[impact.otherParticle]};
+            moveParticle(otherParticle, map, obstacles, impact.time);
+
+            particle.solveContactCollision(otherParticle, m_restitution);
+
+            moveParticle(otherParticle, map, obstacles, deltaTime - impact.time);
+            otherParticle.solveWallCollision(map);
+            m_advanced[impact.otherParticle] = 1;
+        }
+
+        moveParticle(particle, map, obstacles, deltaTime - impact.time);
+        particle.solveWallCollision(map);
+        m_advanced[impact.particle] = 1;
+    }
+}
+
+ContinuousCollision::SweptBox ContinuousCollision::sweptBox(const Particle& particle, std::uint32_t index, const float deltaTime) {
+    const Eigen::Vector2f start{particle.getCenter()};
+    const Eigen::Vector2f end{start + particle.getVelocity() * deltaTime};
+    const float radius{particle.getParticle().w / 2.0f};
+
+    return SweptBox{std::min(start(0), end(0)) - radius, std::max(start(0), end(0)) + radius,
+                    std::min(start(1), end(1)) - radius, std::max(start(1), end(1)) + radius,
+                    index};
+}
+
+void ContinuousCollision::addPairImpact(const std::vector<Particle>& particles, std::uint32_t index, std::uint32_t otherIndex, const float deltaTime) {
+    const float time{pairTimeOfImpact(particles[index], particles[otherIndex], deltaTime)};
+
+    if (time >= 0.0f) {
+        m_impacts.push_back(Impact{time, index, otherIndex, 0});
+    }
+}
+
+void ContinuousCollision::moveParticle(Particle& particle, const Map& map, const ObstacleField& obstacles, const float time) const {
+    // The obstacles only exist inside the map
+    if (obstacles.hasObstacles() && !map.isUnbounded()) {
+        particle.moveAgainstObstacles(obstacles, time, m_restitution);
+    } else {
+        particle.move(time);
+    }
+}
+
+float ContinuousCollision::pairTimeOfImpact(const Particle& particle, const Particle& otherParticle, const float deltaTime) {
+    const Eigen::Vector2f deltaPos{otherParticle.getCenter() - particle.getCenter()};
+    const Eigen::Vector2f deltaVelocity{otherParticle.getVelocity() - particle.getVelocity()};
+    const float contactDistance{(particle.getParticle().w + otherParticle.getParticle().w) / 2.0f};
+
+    // Overlapping pairs are left to the usual overlap solver
+    const float gap{deltaPos.dot(deltaPos) - contactDistance * contactDistance};
+    const float approach{deltaPos.dot(deltaVelocity)};
+
+    if (gap <= 0.0f || approach >= 0.0f) {
+        return -1.0f;
+    }
+
+    const float speedSquared{deltaVelocity.dot(deltaVelocity)};
+    const float discriminant{approach * approach - speedSquared * gap};
+
+    if (discriminant < 0.0f) {
+        return -1.0f;
+    }
+
+    const float time{(-approach - std::sqrt(discriminant)) / speedSquared};
+
+    return time <= deltaTime ? std::max(time, 0.0f) : -1.0f;
+}
+
+void ContinuousCollision::addWallImpacts(const Particle& particle, std::uint32_t index, const Map& map, const float deltaTime) {
+    const Eigen::Vector2f center{particle.getCenter()};
+    const Eigen::Vector2f velocity{particle.getVelocity()};
+    const float radius{particle.getParticle().w / 2.0f};
+    const float sizes[2]{map.getWidth(), map.getHeight()};
+
+    for (std::uint8_t axis = 0; axis < 2; ++axis) {
+        if (velocity(axis) == 0.0f) {
+            continue;
+        }
+
+        const float wall{velocity(axis) > 0.0f ? sizes[axis] - radius : radius};
+        const float time{(wall - center(axis)) / velocity(axis)};
+
+        if (time >= 0.0f && time <= deltaTime) {
+            m_impacts.push_back(Impact{time, index, noParticle, axis});
+        }
+    }
+}
@@ -0,0 +1,272 @@
+#include <SDL3/SDL.h>
+#include <algorithm>
+#include <cstdio>
+#include <exception>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "ensembleRunner.h"
+#include "ensembleErrors.h"
+#include "simulation.h"
+
+namespace {
+    std::string trim(const std::string& text) {
+        const std::size_t begin{text.find_first_not_of(" \t\r")};
+
+        if (begin == std::string::npos) {
+            return "";
+        }
+
+        return text.substr(begin, text.find_last_not_of(" \t\r") - begin + 1);
+    }
+
+    std::vector<double> parseValues(const std::string& key, const std::string& text) {
+        std::vector<double> values;
+        std::size_t begin{0};
+
+        while (begin <= text.size()) {
+            const std::size_t end{std::min(text.find(',', begin), text.size())};
+            const std::string value{trim(text.substr(begin, end - begin))};
+
+            try {
+                std::size_t parsed{0};
+                values.push_back(std::stod(value, &parsed));
+
+                if (parsed != value.size()) {
+                    throw EnsembleError("Invalid value in the sweep spec for ", key);
+                }
+            }
+            catch (const std::logic_error&) {
+                throw EnsembleError("Invalid value in the sweep spec for ", key);
+            }
+
+            begin = end + 1;
+        }
+
+        return values;
+    }
+
+    double parseSingleValue(const std::string& key, const std::string& text) {
+        const std::vector<double> values{parseValues(key, text)};
+
+        if (values.size() != 1) {
+            throw EnsembleError("The sweep spec takes a single value for ", key);
+        }
+
+        return values.front();
+    }
+
+    /// Pin the calling thread on the workerIndex-th core it is allowed to run on
+    void pinCurrentThread(unsigned workerIndex) {
+#ifdef __linux__
+        cpu_set_t allowed;
+        if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0 || CPU_COUNT(&allowed) == 0) {
+            return;
+        }
+
+        int core{-1};
+        for (unsigned k = 0; k <= workerIndex % static_cast<unsigned>(CPU_COUNT(&allowed)); ++k) {
+            do {
+                ++core;
+            } while (!CPU_ISSET(core, &allowed));
+        }
+
+        cpu_set_t cores;
+        CPU_ZERO(&cores);
+        CPU_SET(core, &cores);
+
+        // Not fatal, the scheduler is then free to move the worker
+        if (pthread_setaffinity_np(pthread_self(), sizeof(cores), &cores) != 0) {
+            SDL_Log("Pinning the ensemble worker %u on core %d failed", workerIndex, core);
+        }
+#else
+        (void)workerIndex;
+#endif
+    }
+}
+
+EnsembleRunner::EnsembleRunner(const char* specPath) {
+    parseSpec(specPath);
+}
+
+void EnsembleRunner::parseSpec(const char* specPath) {
+    std::ifstream spec(specPath);
+
+    if (!spec) {
+        throw EnsembleError("Opening the sweep spec failed: ", specPath);
+    }
+
+    std::vector<double> nbParticles{100.0};
+    std::vector<double> minMasses{static_cast<double>(SimulationSettings{}.minMass)};
+    std::vector<double> maxMasses{static_cast<double>(SimulationSettings{}.maxMass)};
+    std::vector<double> maxSpeeds{SimulationSettings{}.maxSpeed};
+    std::vector<double> restitutions{SimulationSettings{}.restitution};
+    int nbRepeats{1};
+    std::uint64_t seed{0};
+
+    std::string line;
+    while (std::getline(spec, line)) {
+        line = trim(line.substr(0, line.find('#')));
+
+        if (line.empty()) {
+            continue;
+        }
+
+        const std::size_t separator{line.find('=')};
+        if (separator == std::string::npos) {
+            throw EnsembleError("Missing '=' in the sweep spec: ", line);
+        }
+
+        const std::string key{trim(line.substr(0, separator))};
+        const std::string value{line.substr(separator + 1)};
+
+        if (key == "particles") {
+            nbParticles = parseValues(key, value);
+        } else if (key == "minMass") {
+            minMasses = parseValues(key, value);
+        } else if (key == "maxMass") {
+            maxMasses = parseValues(key, value);
+        } else if (key == "maxSpeed") {
+            maxSpeeds = parseValues(key, value);
+        } else if (key == "restitution") {
+            restitutions = parseValues(key, value);
+        } else if (key == "repeats") {
+            nbRepeats = static_cast<int>(parseSingleValue(key, value));
+        } else if (key == "steps") {
+            m_nbSteps = static_cast<int>(parseSingleValue(key, value));
+        } else if (key == "deltaTime") {
+            m_deltaTime = static_cast<float>(parseSingleValue(key, value));
+        } else if (key == "seed") {
+            seed = static_cast<std::uint64_t>(parseSingleValue(key, value));
+        } else {
+            throw EnsembleError("Unknown key in the sweep spec: ", key);
+        }
+    }
+
+    if (nbRepeats < 1 || m_nbSteps < 1 || m_deltaTime <= 0.0f) {
+        throw EnsembleError("repeats and steps must be at least 1 and deltaTime positive in the sweep spec");
+    }
+
+    // Every combination, the last key varies the fastest
+    for (double particles : nbParticles) {
+        for (double minMass : minMasses) {
+            for (double maxMass : maxMasses) {
+                for (double maxSpeed : maxSpeeds) {
+                    for (double restitution : restitutions) {
+                        for (int repeat = 0; repeat < nbRepeats; ++repeat) {
+                            SimulationSettings settings;
+                            settings.nbParticles = static_cast<int>(particles);
+                            settings.minMass = static_cast<int>(minMass);
+                            settings.maxMass = static_cast<int>(maxMass);
+                            settings.maxSpeed = static_cast<float>(maxSpeed);
+                            settings.restitution = static_cast<float>(restitution);
+                            settings.seed = seed + m_runs.size();
+                            settings.nbThreads = 1;
+
+                            m_runs.push_back(settings);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+void EnsembleRunner::run(const char* outputPath, unsigned nbWorkers) {
+    m_output.open(outputPath);
+
+    if (!m_output) {
+        throw EnsembleError("Opening the ensemble output failed: ", outputPath);
+    }
+
+    m_output << "run,particles,minMass,maxMass,maxSpeed,restitution,seed,steps,kineticEnergy,potentialEnergy,"
+                "energyDrift,momentum,angularMomentum,fittedTemperature,runMs,error\n";
+
+    if (nbWorkers == 0) {
+        nbWorkers = std::max(1u, std::thread::hardware_concurrency());
+    }
+    nbWorkers = static_cast<unsigned>(std::min<std::size_t>(nbWorkers, m_runs.size()));
+
+    m_nextRun = 0;
+
+    std::vector<std::thread> workers;
+    workers.reserve(nbWorkers);
+
+    for (unsigned i = 0; i < nbWorkers; ++i) {
+        workers.emplace_back(&EnsembleRunner::workerLoop, this, i);
+    }
+
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+
+    m_output.close();
+}
+
+void EnsembleRunner::workerLoop(unsigned workerIndex) {
+    pinCurrentThread(workerIndex);
+
+    while (true) {
+        std::size_t runIndex;
+        {
+            std::lock_guard lock(m_mutex);
+
+            if (m_nextRun >= m_runs.size()) {
+                return;
+            }
+
+            runIndex = m_nextRun++;
+        }
+
+        const Uint64 runStart{SDL_GetPerformanceCounter()};
+        auto elapsedMs = [runStart]() -> double {
+            return static_cast<double>(SDL_GetPerformanceCounter() - runStart) * 1.0e3 / static_cast<double>(SDL_GetPerformanceFrequency());
+        };
+
+        // A failed run (e.g. the particles don't fit on the map) is reported in its row, the sweep goes on
+        try {
+            Simulation simulation(m_runs[runIndex]);
+            simulation.runHeadless(m_nbSteps, m_deltaTime);
+
+            writeRow(runIndex, &simulation, elapsedMs(), "");
+        }
+        catch (const std::exception& e) {
+            writeRow(runIndex, nullptr, elapsedMs(), e.what());
+        }
+    }
+}
+
+void EnsembleRunner::writeRow(std::size_t runIndex, const Simulation* simulation, double runMs, const std::string& error) {
+    const SimulationSettings& settings{m_runs[runIndex]};
+
+    char row[256];
+    int length{std::snprintf(row, sizeof(row), "%zu,%d,%d,%d,%g,%g,%llu,%d,", runIndex, settings.nbParticles, settings.minMass,
+                             settings.maxMass, settings.maxSpeed, settings.restitution, static_cast<unsigned long long>(settings.seed), m_nbSteps)};
+
+    if (simulation) {
+        const Observables& observables{simulation->getObservables()};
+        const ObservableSample& sample{observables.getSample()};
+
+        length += std::snprintf(row + length, sizeof(row) - length, "%.9g,%.9g,%.9g,%.9g,%.9g,%.9g,", sample.kineticEnergy,
+                                sample.potentialEnergy, observables.getEnergyDrift(), sample.momentum.norm(),
+                                sample.angularMomentum, observables.getFittedTemperature());
+    } else {
+        length += std::snprintf(row + length, sizeof(row) - length, ",,,,,,");
+    }
+
+    // Quotes would break the CSV field
+    std::string message{error};
+    std::replace(message.begin(), message.end(), '"', '\'');
+
+    std::snprintf(row + length, sizeof(row) - length, "%.3f,", runMs);
+
+    std::lock_guard lock(m_mutex);
+    m_output << row << '"' << message << "\"\n" << std::flush;
+}
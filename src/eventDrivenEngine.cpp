@@ -0,0 +1,280 @@
+#include <SDL3/SDL.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+#include "Eigen/Dense"
+
+#include "eventDrivenEngine.h"
+#include "map.h"
+#include "particle.h"
+#include "observables.h"
+
+void EventDrivenEngine::load(const std::vector<Particle>& particles, const Map& map) {
+    const std::size_t nbParticles{particles.size()};
+
+    m_time = 0.0;
+    m_width = map.getWidth();
+    m_height = map.getHeight();
+
+    m_positions.resize(nbParticles);
+    m_velocities.resize(nbParticles);
+    m_clocks.assign(nbParticles, 0.0);
+    m_radii.resize(nbParticles);
+    m_masses.resize(nbParticles);
+    m_counts.assign(nbParticles, 0);
+
+    double maxDiameter{1.0};
+
+    for (std::size_t i = 0; i < nbParticles; ++i) {
+        m_positions[i] = particles[i].getCenter().cast<double>();
+        m_velocities[i] = particles[i].getVelocity().cast<double>();
+        m_radii[i] = particles[i].getParticle().w / 2.0;
+        m_masses[i] = particles[i].getMass();
+
+        maxDiameter = std::max(maxDiameter, 2.0 * m_radii[i]);
+    }
+
+    // Cells at least as large as a particle (pairs are only searched in the surrounding cells),
+    // and around one particle per cell in dilute systems so that predictions stay cheap
+    const double cellSize{std::max(maxDiameter, std::sqrt(m_width * m_height / static_cast<double>(std::max<std::size_t>(nbParticles, 1))))};
+    m_nbColumns = std::max(1, static_cast<int>(m_width / cellSize));
+    m_nbRows = std::max(1, static_cast<int>(m_height / cellSize));
+
+    m_cellHeads.assign(static_cast<std::size_t>(m_nbColumns) * m_nbRows, none);
+    m_cells.resize(nbParticles);
+    m_next.resize(nbParticles);
+    m_previous.resize(nbParticles);
+
+    for (std::uint32_t i = 0; i < nbParticles; ++i) {
+        const int col{std::clamp(static_cast<int>(m_positions[i](0) / (m_width / m_nbColumns)), 0, m_nbColumns - 1)};
+        const int row{std::clamp(static_cast<int>(m_positions[i](1) / (m_height / m_nbRows)), 0, m_nbRows - 1)};
+
+        insertInCell(i, static_cast<std::uint32_t>(row * m_nbColumns + col));
+    }
+
+    m_events.assign(nbParticles, Event{});
+    m_queue.reset(nbParticles);
+
+    for (std::uint32_t i = 0; i < nbParticles; ++i) {
+        predict(i);
+    }
+}
+
+void EventDrivenEngine::advance(double duration) {
+    const double targetTime{m_time + duration};
+
+    while (!m_queue.empty() && m_queue.topKey() <= targetTime) {
+        const std::uint32_t i{m_queue.top()};
+        const Event event{m_events[i]};
+
+        m_time = m_queue.topKey();
+
+        switch (event.type) {
+            case EventType::pair: {
+                const std::uint32_t j{event.partner};
+
+                // The partner changed its trajectory since the prediction
+                if (m_counts[j] != event.partnerCount) {
+                    ++m_nbInvalidEvents;
+                    predict(i);
+                    break;
+                }
+
+                moveTo(i, m_time);
+                moveTo(j, m_time);
+
+                // Perfectly elastic collision along the line of centers, same outcome as Particle::solveCollision
+                const Eigen::Vector2d normalUnitVector{(m_positions[j] - m_positions[i]).normalized()};
+                const double relativeNormalVelocity{(m_velocities[j] - m_velocities[i]).dot(normalUnitVector)};
+                const double impulse{2.0 * m_masses[i] * m_masses[j] / (m_masses[i] + m_masses[j]) * relativeNormalVelocity};
+
+                m_velocities[i] += (impulse / m_masses[i]) * normalUnitVector;
+                m_velocities[j] -= (impulse / m_masses[j]) * normalUnitVector;
+
+                ++m_counts[i];
+                ++m_counts[j];
+                ++m_nbPairCollisions;
+
+                predict(i);
+                predict(j);
+                break;
+            }
+            case EventType::wall: {
+                moveTo(i, m_time);
+
+                const double size{event.axis == 0 ? m_width : m_height};
+                m_velocities[i](event.axis) = -m_velocities[i](event.axis);
+                m_positions[i](event.axis) = std::clamp(m_positions[i](event.axis), m_radii[i], size - m_radii[i]);
+
+                ++m_counts[i];
+                ++m_nbWallCollisions;
+
+                predict(i);
+                break;
+            }
+            case EventType::cellCrossing: {
+                moveTo(i, m_time);
+
+                // The new cell comes from the crossing direction, not from the position, so rounding can't loop
+                int col{static_cast<int>(m_cells[i] % m_nbColumns)};
+                int row{static_cast<int>(m_cells[i] / m_nbColumns)};
+                (event.axis == 0 ? col : row) += event.direction;
+
+                removeFromCell(i);
+                insertInCell(i, static_cast<std::uint32_t>(row * m_nbColumns + col));
+
+                ++m_nbCellCrossings;
+
+                predict(i);
+                break;
+            }
+            case EventType::none:
+                m_queue.update(i, std::numeric_limits<double>::infinity());
+                break;
+        }
+    }
+
+    m_time = targetTime;
+}
+
+void EventDrivenEngine::store(std::vector<Particle>& particles, const Map& map, Observables& observables) const {
+    for (std::uint32_t i = 0; i < particles.size(); ++i) {
+        const Eigen::Vector2d center{positionAt(i, m_time)};
+
+        particles[i].setCoordinates(map, static_cast<float>(center(0) - m_radii[i]), static_cast<float>(center(1) - m_radii[i]));
+        particles[i].setVelocity(m_velocities[i].cast<float>());
+
+        observables.accumulate(0, particles[i]);
+    }
+}
+
+void EventDrivenEngine::moveTo(std::uint32_t i, double time) {
+    m_positions[i] = positionAt(i, time);
+    m_clocks[i] = time;
+}
+
+void EventDrivenEngine::predict(std::uint32_t i) {
+    constexpr double infinity{std::numeric_limits<double>::infinity()};
+
+    Event best{};
+    double bestTime{infinity};
+
+    const Eigen::Vector2d position{positionAt(i, m_time)};
+    const Eigen::Vector2d& velocity{m_velocities[i]};
+    const double radius{m_radii[i]};
+
+    const int cellCoordinates[2]{static_cast<int>(m_cells[i] % m_nbColumns), static_cast<int>(m_cells[i] / m_nbColumns)};
+    const int nbCells[2]{m_nbColumns, m_nbRows};
+    const double sizes[2]{m_width, m_height};
+
+    for (std::uint8_t axis = 0; axis < 2; ++axis) {
+        if (velocity(axis) == 0.0) {
+            continue;
+        }
+
+        // Wall
+        const double wall{velocity(axis) > 0.0 ? sizes[axis] - radius : radius};
+        const double wallTime{m_time + std::max(0.0, (wall - position(axis)) / velocity(axis))};
+
+        if (wallTime < bestTime) {
+            bestTime = wallTime;
+            best = Event{EventType::wall, axis, 0, 0, 0};
+        }
+
+        // Cell crossing, the border cells have no crossing towards the wall
+        const double cellSize{sizes[axis] / nbCells[axis]};
+        const std::int8_t direction{static_cast<std::int8_t>(velocity(axis) > 0.0 ? 1 : -1)};
+        const int nextCell{cellCoordinates[axis] + direction};
+
+        if (nextCell >= 0 && nextCell < nbCells[axis]) {
+            const double border{(direction > 0 ? nextCell : cellCoordinates[axis]) * cellSize};
+            const double crossingTime{m_time + std::max(0.0, (border - position(axis)) / velocity(axis))};
+
+            if (crossingTime < bestTime) {
+                bestTime = crossingTime;
+                best = Event{EventType::cellCrossing, axis, direction, 0, 0};
+            }
+        }
+    }
+
+    // Pairs in the surrounding cells
+    for (int row = std::max(0, cellCoordinates[1] - 1); row <= std::min(m_nbRows - 1, cellCoordinates[1] + 1); ++row) {
+        for (int col = std::max(0, cellCoordinates[0] - 1); col <= std::min(m_nbColumns - 1, cellCoordinates[0] + 1); ++col) {
+            for (std::uint32_t j = m_cellHeads[row * m_nbColumns + col]; j != none; j = m_next[j]) {
+                if (j == i) {
+                    continue;
+                }
+
+                const double collisionTime{pairCollisionTime(i, j)};
+
+                if (collisionTime < bestTime) {
+                    bestTime = collisionTime;
+                    best = Event{EventType::pair, 0, 0, j, m_counts[j]};
+                }
+
+                // The partner may have nothing planned before this collision
+                if (collisionTime < m_queue.getKey(j)) {
+                    m_events[j] = Event{EventType::pair, 0, 0, i, m_counts[i]};
+                    m_queue.update(j, collisionTime);
+                }
+            }
+        }
+    }
+
+    m_events[i] = best;
+    m_queue.update(i, bestTime);
+}
+
+double EventDrivenEngine::pairCollisionTime(std::uint32_t i, std::uint32_t j) const {
+    constexpr double infinity{std::numeric_limits<double>::infinity()};
+
+    const Eigen::Vector2d deltaPos{positionAt(j, m_time) - positionAt(i, m_time)};
+    const Eigen::Vector2d deltaVelocity{m_velocities[j] - m_velocities[i]};
+
+    // Moving apart
+    const double approach{deltaPos.dot(deltaVelocity)};
+    if (approach >= 0.0) {
+        return infinity;
+    }
+
+    const double contactDistance{m_radii[i] + m_radii[j]};
+    const double distanceSquared{deltaPos.dot(deltaPos)};
+    const double speedSquared{deltaVelocity.dot(deltaVelocity)};
+
+    const double discriminant{approach * approach - speedSquared * (distanceSquared - contactDistance * contactDistance)};
+    if (discriminant < 0.0) {
+        return infinity;
+    }
+
+    // Already touching (rounding) and still approaching: collide right away
+    if (distanceSquared <= contactDistance * contactDistance) {
+        return m_time;
+    }
+
+    return m_time + std::max(0.0, -(approach + std::sqrt(discriminant)) / speedSquared);
+}
+
+void EventDrivenEngine::insertInCell(std::uint32_t i, std::uint32_t cell) {
+    m_cells[i] = cell;
+    m_previous[i] = none;
+    m_next[i] = m_cellHeads[cell];
+
+    if (m_next[i] != none) {
+        m_previous[m_next[i]] = i;
+    }
+
+    m_cellHeads[cell] = i;
+}
+
+void EventDrivenEngine::removeFromCell(std::uint32_t i) {
+    if (m_previous[i] != none) {
+        m_next[m_previous[i]] = m_next[i];
+    } else {
+        m_cellHeads[m_cells[i]] = m_next[i];
+    }
+
+    if (m_next[i] != none) {
+        m_previous[m_next[i]] = m_previous[i];
+    }
+}
@@ -0,0 +1,520 @@
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include "Eigen/Dense"
+
+#include "fastMultipole.h"
+#include "particle.h"
+
+// The expansions of a box are scaled by its radius r: multipole a_k / r^k and local b_l r^l,
+// so the powers stay near 1 whatever the size of the box and high orders don't overflow.
+
+void FastMultipole::compute(const std::vector<Particle>& particles, float gravitationalConstant) {
+    const std::size_t nbParticles{particles.size()};
+
+    m_gravitationalConstant = gravitationalConstant;
+    m_order = std::clamp(m_order, 1, maxOrder);
+    m_accelerations.assign(nbParticles, Eigen::Vector2f::Zero());
+    m_potentials.assign(nbParticles, 0.0);
+    m_potentialEnergy = 0.0;
+
+    if (nbParticles < 2) {
+        m_nodes.clear();
+        m_m2lSources.clear();
+        m_p2pSources.clear();
+        return;
+    }
+
+    if (m_binomials.empty()) {
+        const int size{2 * maxOrder + 1};
+        m_binomials.assign(static_cast<std::size_t>(size) * size, 0.0);
+
+        for (int n = 0; n < size; ++n) {
+            m_binomials[static_cast<std::size_t>(n) * size] = 1.0;
+
+            for (int k = 1; k <= n; ++k) {
+                m_binomials[static_cast<std::size_t>(n) * size + k] = getBinomial(n - 1, k - 1) + getBinomial(n - 1, k);
+            }
+        }
+    }
+
+    m_positions.resize(nbParticles);
+    m_masses.resize(nbParticles);
+
+    for (std::size_t i = 0; i < nbParticles; ++i) {
+        const Eigen::Vector2f center{particles[i].getCenter()};
+        m_positions[i] = Complex{center(0), center(1)};
+        m_masses[i] = particles[i].getMass();
+    }
+
+    buildTree();
+
+    m_m2lSources.clear();
+    m_p2pSources.clear();
+    m_candidates.assign(1, 0);
+    buildInteractionLists(0, 0, 1);
+
+    const std::size_t nbCoefficients{m_nodes.size() * (m_order + 1)};
+    m_multipoles.resize(nbCoefficients);
+    m_locals.resize(nbCoefficients);
+
+    upwardPass();
+    downwardPass();
+    evaluateLeaves(gravitationalConstant);
+
+    // Each pair is counted from both sides
+    double potentialEnergy{0.0};
+
+    for (std::size_t i = 0; i < nbParticles; ++i) {
+        potentialEnergy += m_masses[i] * m_potentials[i];
+    }
+
+    m_potentialEnergy = 0.5 * gravitationalConstant * potentialEnergy;
+}
+
+MultipoleError FastMultipole::measureError(const std::vector<Particle>& particles, std::size_t nbSamples) const {
+    const std::size_t nbParticles{std::min(particles.size(), m_accelerations.size())};
+    nbSamples = std::min(nbSamples, nbParticles);
+
+    MultipoleError error;
+
+    if (nbSamples == 0) {
+        return error;
+    }
+
+    const double softeningSquared{static_cast<double>(m_softening) * m_softening};
+    std::vector<double> relativeErrors(nbSamples, 0.0);
+
+    m_threadPool.parallelFor(nbSamples, [&](std::size_t begin, std::size_t end, unsigned) {
+        for (std::size_t sample = begin; sample < end; ++sample) {
+            const std::size_t i{sample * nbParticles / nbSamples};
+            const Eigen::Vector2f center{particles[i].getCenter()};
+            double ax{0.0};
+            double ay{0.0};
+
+            for (std::size_t j = 0; j < nbParticles; ++j) {
+                const Eigen::Vector2f otherCenter{particles[j].getCenter()};
+                const double dx{static_cast<double>(center(0)) - otherCenter(0)};
+                const double dy{static_cast<double>(center(1)) - otherCenter(1)};
+                const double distanceSquared{dx * dx + dy * dy};
+
+                if (j == i || distanceSquared == 0.0) {
+                    continue;
+                }
+
+                const double factor{m_gravitationalConstant * particles[j].getMass() / (distanceSquared + softeningSquared)};
+                ax -= factor * dx;
+                ay -= factor * dy;
+            }
+
+            const double exactNorm{std::hypot(ax, ay)};
+            const double difference{std::hypot(m_accelerations[i](0) - ax, m_accelerations[i](1) - ay)};
+            relativeErrors[sample] = exactNorm > 0.0 ? difference / exactNorm : difference;
+        }
+    });
+
+    double sumSquared{0.0};
+
+    for (const double relativeError : relativeErrors) {
+        error.maxRelativeError = std::max(error.maxRelativeError, relativeError);
+        sumSquared += relativeError * relativeError;
+    }
+
+    error.rmsRelativeError = std::sqrt(sumSquared / nbSamples);
+    error.nbSamples = nbSamples;
+    return error;
+}
+
+void FastMultipole::buildTree() {
+    const std::size_t nbParticles{m_positions.size()};
+
+    double minX{std::numeric_limits<double>::max()};
+    double minY{std::numeric_limits<double>::max()};
+    double maxX{std::numeric_limits<double>::lowest()};
+    double maxY{std::numeric_limits<double>::lowest()};
+
+    for (const Complex& position : m_positions) {
+        minX = std::min(minX, position.real());
+        minY = std::min(minY, position.imag());
+        maxX = std::max(maxX, position.real());
+        maxY = std::max(maxY, position.imag());
+    }
+
+    // Slightly larger so the particles on the far edges are inside
+    const double halfSize{std::max({maxX - minX, maxY - minY, 1.0}) * 0.5 * (1.0 + 1e-9)};
+
+    m_sortedParticles.resize(nbParticles);
+
+    for (std::size_t i = 0; i < nbParticles; ++i) {
+        m_sortedParticles[i] = static_cast<std::uint32_t>(i);
+    }
+
+    m_nodes.clear();
+    m_nodes.push_back(Node{Complex{(minX + maxX) / 2.0, (minY + maxY) / 2.0}, halfSize,
+                           0, static_cast<std::uint32_t>(nbParticles), 0, 0, 0, 0, 0, 0, 0});
+
+    m_levelOffsets.assign(1, 0);
+    std::size_t levelBegin{0};
+
+    while (levelBegin < m_nodes.size()) {
+        const std::size_t levelEnd{m_nodes.size()};
+
+        for (std::size_t node = levelBegin; node < levelEnd; ++node) {
+            splitNode(static_cast<std::uint32_t>(node));
+        }
+
+        m_levelOffsets.push_back(static_cast<std::uint32_t>(levelEnd));
+        levelBegin = levelEnd;
+    }
+
+    m_sortedPositions.resize(nbParticles);
+    m_sortedMasses.resize(nbParticles);
+
+    for (std::size_t i = 0; i < nbParticles; ++i) {
+        m_sortedPositions[i] = m_positions[m_sortedParticles[i]];
+        m_sortedMasses[i] = m_masses[m_sortedParticles[i]];
+    }
+
+    m_leaves.clear();
+
+    for (std::uint32_t node = 0; node < m_nodes.size(); ++node) {
+        if (m_nodes[node].isLeaf()) {
+            m_leaves.push_back(node);
+        }
+    }
+}
+
+void FastMultipole::splitNode(std::uint32_t index) {
+    // Copied, the children are pushed into m_nodes
+    const Node node{m_nodes[index]};
+
+    // Particles at the same place can't be separated, their box stays a larger leaf
+    constexpr double minHalfSize{1e-6};
+
+    if (node.end - node.begin <= leafSize || node.halfSize < minHalfSize) {
+        return;
+    }
+
+    const auto first{m_sortedParticles.begin() + node.begin};
+    const auto last{m_sortedParticles.begin() + node.end};
+    const double centerX{node.center.real()};
+    const double centerY{node.center.imag()};
+
+    const auto bottom{std::partition(first, last, [&](std::uint32_t i) {return m_positions[i].imag() < centerY;})};
+    const auto bottomLeft{std::partition(first, bottom, [&](std::uint32_t i) {return m_positions[i].real() < centerX;})};
+    const auto topLeft{std::partition(bottom, last, [&](std::uint32_t i) {return m_positions[i].real() < centerX;})};
+
+    const std::uint32_t bounds[5]{
+        node.begin,
+        static_cast<std::uint32_t>(bottomLeft - m_sortedParticles.begin()),
+        static_cast<std::uint32_t>(bottom - m_sortedParticles.begin()),
+        static_cast<std::uint32_t>(topLeft - m_sortedParticles.begin()),
+        node.end
+    };
+
+    const double quarter{node.halfSize / 2.0};
+    const Complex offsets[4]{{-quarter, -quarter}, {quarter, -quarter}, {-quarter, quarter}, {quarter, quarter}};
+
+    const std::uint32_t firstChild{static_cast<std::uint32_t>(m_nodes.size())};
+
+    for (int quadrant = 0; quadrant < 4; ++quadrant) {
+        if (bounds[quadrant] == bounds[quadrant + 1]) {
+            continue;
+        }
+
+        m_nodes.push_back(Node{node.center + offsets[quadrant], quarter,
+                               bounds[quadrant], bounds[quadrant + 1], index, 0, 0, 0, 0, 0, 0});
+    }
+
+    m_nodes[index].firstChild = firstChild;
+    m_nodes[index].nbChildren = static_cast<std::uint32_t>(m_nodes.size()) - firstChild;
+}
+
+void FastMultipole::buildInteractionLists(std::uint32_t target, std::size_t candidatesBegin, std::size_t candidatesEnd) {
+    Node& node{m_nodes[target]};
+    node.m2lBegin = static_cast<std::uint32_t>(m_m2lSources.size());
+
+    if (node.isLeaf()) {
+        // A leaf can't be split further: the sources are opened until they are well separated or leaves
+        node.p2pBegin = static_cast<std::uint32_t>(m_p2pSources.size());
+
+        for (std::size_t candidate = candidatesBegin; candidate < m_candidates.size(); ++candidate) {
+            const std::uint32_t source{m_candidates[candidate]};
+            const Node& sourceNode{m_nodes[source]};
+
+            if (wellSeparated(node, sourceNode)) {
+                m_m2lSources.push_back(source);
+            } else if (sourceNode.isLeaf()) {
+                m_p2pSources.push_back(source);
+            } else {
+                for (std::uint32_t child = 0; child < sourceNode.nbChildren; ++child) {
+                    m_candidates.push_back(sourceNode.firstChild + child);
+                }
+            }
+        }
+
+        node.m2lEnd = static_cast<std::uint32_t>(m_m2lSources.size());
+        node.p2pEnd = static_cast<std::uint32_t>(m_p2pSources.size());
+        return;
+    }
+
+    // The sources too close to the box are handed down to its children, opened when larger than the box
+    const std::size_t passedBegin{m_candidates.size()};
+
+    for (std::size_t candidate = candidatesBegin; candidate < candidatesEnd; ++candidate) {
+        const std::uint32_t source{m_candidates[candidate]};
+        const Node& sourceNode{m_nodes[source]};
+
+        if (wellSeparated(node, sourceNode)) {
+            m_m2lSources.push_back(source);
+        } else if (sourceNode.isLeaf() || sourceNode.halfSize < node.halfSize) {
+            m_candidates.push_back(source);
+        } else {
+            for (std::uint32_t child = 0; child < sourceNode.nbChildren; ++child) {
+                m_candidates.push_back(sourceNode.firstChild + child);
+            }
+        }
+    }
+
+    node.m2lEnd = static_cast<std::uint32_t>(m_m2lSources.size());
+    node.p2pBegin = 0;
+    node.p2pEnd = 0;
+
+    const std::size_t passedEnd{m_candidates.size()};
+    const std::uint32_t firstChild{node.firstChild};
+    const std::uint32_t nbChildren{node.nbChildren};
+
+    for (std::uint32_t child = 0; child < nbChildren; ++child) {
+        buildInteractionLists(firstChild + child, passedBegin, passedEnd);
+        m_candidates.resize(passedEnd);
+    }
+}
+
+bool FastMultipole::wellSeparated(const Node& target, const Node& source) const {
+    constexpr double separation{0.5};
+    const double radii{(target.halfSize + source.halfSize) * std::sqrt(2.0)};
+    return radii < separation * std::abs(source.center - target.center);
+}
+
+void FastMultipole::upwardPass() {
+    const int order{m_order};
+
+    // Deepest level first, the children are complete before their parent
+    for (std::size_t level = m_levelOffsets.size() - 1; level-- > 0;) {
+        const std::uint32_t levelBegin{m_levelOffsets[level]};
+        const std::uint32_t levelEnd{m_levelOffsets[level + 1]};
+
+        m_threadPool.parallelFor(levelEnd - levelBegin, [&](std::size_t begin, std::size_t end, unsigned) {
+            Complex powers[maxOrder + 1];
+            Complex childPowers[maxOrder + 1];
+
+            for (std::size_t index = levelBegin + begin; index < levelBegin + end; ++index) {
+                const std::uint32_t node{static_cast<std::uint32_t>(index)};
+                const Node& box{m_nodes[node]};
+                const double radius{box.halfSize * std::sqrt(2.0)};
+                Complex* multipole{getMultipole(node)};
+
+                std::fill(multipole, multipole + order + 1, Complex{});
+
+                if (box.isLeaf()) {
+                    // P2M: a_0 = sum(m), a_k = -sum(m (z - c)^k) / k
+                    for (std::uint32_t p = box.begin; p < box.end; ++p) {
+                        const std::uint32_t particle{m_sortedParticles[p]};
+                        const Complex offset{(m_positions[particle] - box.center) / radius};
+                        const double mass{m_masses[particle]};
+                        Complex power{1.0};
+
+                        multipole[0] += mass;
+
+                        for (int k = 1; k <= order; ++k) {
+                            power *= offset;
+                            multipole[k] -= mass * power / static_cast<double>(k);
+                        }
+                    }
+
+                    continue;
+                }
+
+                // M2M: b_l = -a_0 z0^l / l + sum_k a_k z0^(l-k) C(l-1, k-1), z0 = child center - parent center
+                for (std::uint32_t c = 0; c < box.nbChildren; ++c) {
+                    const std::uint32_t child{box.firstChild + c};
+                    const Node& childBox{m_nodes[child]};
+                    const Complex* childMultipole{getMultipole(child)};
+                    const Complex shift{(childBox.center - box.center) / radius};
+                    const double ratio{childBox.halfSize / box.halfSize};
+
+                    powers[0] = 1.0;
+                    childPowers[0] = childMultipole[0];
+
+                    for (int k = 1; k <= order; ++k) {
+                        powers[k] = powers[k - 1] * shift;
+                        childPowers[k] = childMultipole[k] * std::pow(ratio, k);
+                    }
+
+                    multipole[0] += childPowers[0];
+
+                    for (int l = 1; l <= order; ++l) {
+                        Complex coefficient{-childPowers[0] * powers[l] / static_cast<double>(l)};
+
+                        for (int k = 1; k <= l; ++k) {
+                            coefficient += childPowers[k] * powers[l - k] * getBinomial(l - 1, k - 1);
+                        }
+
+                        multipole[l] += coefficient;
+                    }
+                }
+            }
+        });
+    }
+}
+
+void FastMultipole::downwardPass() {
+    const int order{m_order};
+
+    // Top level first, a box adds the local expansion of its parent to the one of its own interaction list
+    for (std::size_t level = 0; level + 1 < m_levelOffsets.size(); ++level) {
+        const std::uint32_t levelBegin{m_levelOffsets[level]};
+        const std::uint32_t levelEnd{m_levelOffsets[level + 1]};
+
+        m_threadPool.parallelFor(levelEnd - levelBegin, [&](std::size_t begin, std::size_t end, unsigned) {
+            Complex targetPowers[maxOrder + 1];
+            Complex sourcePowers[maxOrder + 1];
+
+            for (std::size_t index = levelBegin + begin; index < levelBegin + end; ++index) {
+                const std::uint32_t node{static_cast<std::uint32_t>(index)};
+                const Node& box{m_nodes[node]};
+                const double radius{box.halfSize * std::sqrt(2.0)};
+                Complex* local{getLocal(node)};
+
+                std::fill(local, local + order + 1, Complex{});
+
+                // L2L: c_m = sum_l b_l C(l, m) (-d)^(l-m), d = parent center - child center
+                if (node != 0) {
+                    const Node& parentBox{m_nodes[box.parent]};
+                    const Complex* parentLocal{getLocal(box.parent)};
+                    const Complex shift{(box.center - parentBox.center) / (parentBox.halfSize * std::sqrt(2.0))};
+                    const double ratio{box.halfSize / parentBox.halfSize};
+
+                    sourcePowers[0] = 1.0;
+
+                    for (int k = 1; k <= order; ++k) {
+                        sourcePowers[k] = sourcePowers[k - 1] * shift;
+                    }
+
+                    double scale{1.0};
+
+                    for (int m = 0; m <= order; ++m) {
+                        Complex coefficient{};
+
+                        for (int l = m; l <= order; ++l) {
+                            coefficient += parentLocal[l] * sourcePowers[l - m] * getBinomial(l, m);
+                        }
+
+                        local[m] += coefficient * scale;
+                        scale *= ratio;
+                    }
+                }
+
+                // M2L: b_0 = a_0 log(-z0) + sum_k a_k (-1)^k / z0^k,
+                //      b_l = -a_0 / (l z0^l) + sum_k a_k (-1)^k C(l+k-1, k-1) / z0^(l+k), z0 = source center - target center
+                for (std::uint32_t m2l = box.m2lBegin; m2l < box.m2lEnd; ++m2l) {
+                    const std::uint32_t source{m_m2lSources[m2l]};
+                    const Node& sourceBox{m_nodes[source]};
+                    const Complex* multipole{getMultipole(source)};
+                    const Complex separation{sourceBox.center - box.center};
+                    const Complex targetRatio{radius / separation};
+                    const Complex sourceRatio{-sourceBox.halfSize * std::sqrt(2.0) / separation};
+
+                    targetPowers[0] = 1.0;
+                    sourcePowers[0] = multipole[0];
+                    Complex power{1.0};
+
+                    for (int k = 1; k <= order; ++k) {
+                        targetPowers[k] = targetPowers[k - 1] * targetRatio;
+                        power *= sourceRatio;
+                        sourcePowers[k] = multipole[k] * power;
+                    }
+
+                    Complex constant{multipole[0] * std::log(-separation)};
+
+                    for (int k = 1; k <= order; ++k) {
+                        constant += sourcePowers[k];
+                    }
+
+                    local[0] += constant;
+
+                    for (int l = 1; l <= order; ++l) {
+                        Complex coefficient{-multipole[0] / static_cast<double>(l)};
+
+                        for (int k = 1; k <= order; ++k) {
+                            coefficient += sourcePowers[k] * getBinomial(l + k - 1, k - 1);
+                        }
+
+                        local[l] += coefficient * targetPowers[l];
+                    }
+                }
+            }
+        });
+    }
+}
+
+void FastMultipole::evaluateLeaves(double gravitationalConstant) {
+    const int order{m_order};
+    const double softeningSquared{static_cast<double>(m_softening) * m_softening};
+
+    m_threadPool.parallelFor(m_leaves.size(), [&](std::size_t begin, std::size_t end, unsigned) {
+        for (std::size_t leaf = begin; leaf < end; ++leaf) {
+            const std::uint32_t node{m_leaves[leaf]};
+            const Node& box{m_nodes[node]};
+            const double radius{box.halfSize * std::sqrt(2.0)};
+            const Complex* local{getLocal(node)};
+
+            for (std::uint32_t p = box.begin; p < box.end; ++p) {
+                const Complex position{m_sortedPositions[p]};
+
+                // L2P, Horner on the potential and its derivative
+                const Complex offset{(position - box.center) / radius};
+                Complex potential{local[order]};
+                Complex derivative{};
+
+                for (int l = order - 1; l >= 0; --l) {
+                    derivative = derivative * offset + potential;
+                    potential = potential * offset + local[l];
+                }
+
+                derivative /= radius;
+
+                // P2P: the gradient of log|z| is 1 / conj(z) = z / |z|^2
+                double potentialSum{potential.real()};
+                Complex field{std::conj(derivative)};
+
+                for (std::uint32_t p2p = box.p2pBegin; p2p < box.p2pEnd; ++p2p) {
+                    const Node& sourceBox{m_nodes[m_p2pSources[p2p]]};
+
+                    for (std::uint32_t q = sourceBox.begin; q < sourceBox.end; ++q) {
+                        const Complex difference{position - m_sortedPositions[q]};
+                        const double distanceSquared{std::norm(difference)};
+
+                        // Itself, or a particle at the same place which doesn't pull in any direction
+                        if (distanceSquared == 0.0) {
+                            continue;
+                        }
+
+                        const double softenedSquared{distanceSquared + softeningSquared};
+                        field += m_sortedMasses[q] * difference / softenedSquared;
+                        potentialSum += m_sortedMasses[q] * 0.5 * std::log(softenedSquared);
+                    }
+                }
+
+                // Pulled down the potential, a = -G grad(phi)
+                const std::uint32_t particle{m_sortedParticles[p]};
+                m_accelerations[particle] = Eigen::Vector2f{static_cast<float>(-gravitationalConstant * field.real()),
+                                                            static_cast<float>(-gravitationalConstant * field.imag())};
+                m_potentials[particle] = potentialSum;
+            }
+        }
+    });
+}
@@ -0,0 +1,39 @@
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+
+#include "frameArena.h"
+
+FrameArena::FrameArena(std::size_t capacity) {
+    allocateBuffer(capacity);
+}
+
+void FrameArena::reset() {
+    const std::size_t overflow{m_overflow.getNbBytes()};
+
+    if (overflow == 0) {
+        m_resource->release();
+        return;
+    }
+
+    // The chunks taken from the heap are freed with the old resource, the next frames fit in the new buffer
+    allocateBuffer(m_capacity + overflow);
+    ++m_nbGrowths;
+}
+
+void FrameArena::allocateBuffer(std::size_t capacity) {
+    m_resource.reset();
+    m_buffer = std::make_unique_for_overwrite<std::byte[]>(capacity);
+    m_capacity = capacity;
+    m_overflow.resetNbBytes();
+    m_resource.emplace(m_buffer.get(), m_capacity, &m_overflow);
+}
+
+void* FrameArena::OverflowResource::do_allocate(std::size_t bytes, std::size_t alignment) {
+    m_nbBytes += bytes;
+    return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+}
+
+void FrameArena::OverflowResource::do_deallocate(void* pointer, std::size_t bytes, std::size_t alignment) {
+    std::pmr::new_delete_resource()->deallocate(pointer, bytes, alignment);
+}
@@ -0,0 +1,91 @@
+#include <SDL3/SDL.h>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "frameRecorder.h"
+#include "map.h"
+#include "particle.h"
+#include "offlineRenderer.h"
+#include "asyncFileWriter.h"
+
+FrameRecorder::FrameRecorder(int width, int height, const Map& map, unsigned nbThreads, AsyncFileWriter& fileWriter, std::string directory)
+    : m_width(width),
+      m_height(height),
+      m_fileWriter(fileWriter),
+      m_directory(std::move(directory)),
+      m_threadPool(nbThreads),
+      m_renderer(width, height, m_threadPool),
+      m_snapshots{Snapshot(map), Snapshot(map)} {
+    m_recorder = std::thread(&FrameRecorder::recorderLoop, this);
+}
+
+FrameRecorder::~FrameRecorder() {
+    {
+        std::lock_guard lock(m_mutex);
+        m_stopping = true;
+    }
+    m_hasWork.notify_one();
+
+    m_recorder.join();
+}
+
+void FrameRecorder::record(const std::vector<Particle>& particles, const Map& map, const SDL_FRect camera) {
+    int index;
+
+    {
+        std::unique_lock lock(m_mutex);
+        m_hasRoom.wait(lock, [this] {return !m_hasPending;});
+        index = m_fillIndex;
+    }
+
+    // The recorder thread never touches the snapshot being filled, the copy doesn't need the lock
+    Snapshot& snapshot{m_snapshots[index]};
+    snapshot.particles = particles;
+    snapshot.map.copySolidCells(map);
+    snapshot.camera = camera;
+    snapshot.style = m_style;
+    snapshot.index = m_nbRecordedFrames++;
+
+    {
+        std::lock_guard lock(m_mutex);
+        m_hasPending = true;
+    }
+    m_hasWork.notify_one();
+}
+
+void FrameRecorder::recorderLoop() {
+    while (true) {
+        int index;
+
+        {
+            std::unique_lock lock(m_mutex);
+            m_hasWork.wait(lock, [this] {return m_stopping || m_hasPending;});
+
+            // The last snapshot is still rendered when stopping, no frame is lost
+            if (!m_hasPending) {
+                return;
+            }
+
+            index = m_fillIndex;
+            m_fillIndex = 1 - index;
+            m_hasPending = false;
+        }
+        m_hasRoom.notify_one();
+
+        const Snapshot& snapshot{m_snapshots[index]};
+        m_renderer.setStyle(snapshot.style);
+        m_renderer.render(snapshot.particles, snapshot.map, snapshot.camera);
+
+        std::vector<std::uint8_t> bytes{m_fileWriter.acquireBuffer()};
+        m_renderer.encodePPM(bytes);
+
+        char name[32];
+        std::snprintf(name, sizeof(name), "/frame_%06d.ppm", snapshot.index);
+
+        m_fileWriter.push(m_directory + name, std::move(bytes));
+    }
+}
@@ -0,0 +1,376 @@
+#include <SDL3/SDL.h>
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "Eigen/Dense"
+
+#include "historyBuffer.h"
+#include "historyErrors.h"
+#include "particle.h"
+#include "particleStore.h"
+#include "varint.h"
+
+namespace {
+    template <typename T>
+    void appendArray(std::vector<std::uint8_t>& bytes, const std::vector<T>& values) {
+        const auto* data{reinterpret_cast<const std::uint8_t*>(values.data())};
+        bytes.insert(bytes.end(), data, data + values.size() * sizeof(T));
+    }
+
+    template <typename T>
+    void readArray(const std::uint8_t*& data, std::vector<T>& values) {
+        std::memcpy(values.data(), data, values.size() * sizeof(T));
+        data += values.size() * sizeof(T);
+    }
+
+    /// Same float operations as Particle::move, so an undisturbed particle is predicted bit for bit
+    std::uint32_t predictPosition(std::uint32_t position, std::uint32_t velocity, float deltaTime) {
+        return std::bit_cast<std::uint32_t>(std::bit_cast<float>(position) + std::bit_cast<float>(velocity) * deltaTime);
+    }
+
+    void appendResidual(std::vector<std::uint8_t>& bytes, std::uint32_t value, std::uint32_t predicted) {
+        Varint::append(bytes, Varint::zigzag(static_cast<std::int32_t>(value - predicted)));
+    }
+
+    std::uint32_t readResidual(const std::uint8_t*& data, const std::uint8_t* end, std::uint32_t predicted) {
+        std::uint64_t residual;
+
+        if (!Varint::read(data, end, residual)) {
+            throw HistoryError("A history delta is corrupted");
+        }
+
+        return predicted + static_cast<std::uint32_t>(Varint::unzigzag(static_cast<std::uint32_t>(residual)));
+    }
+}
+
+void HistoryBuffer::State::resize(std::size_t size) {
+    ids.resize(size);
+    masses.resize(size);
+    x.resize(size);
+    y.resize(size);
+    velocityX.resize(size);
+    velocityY.resize(size);
+}
+
+void HistoryBuffer::record(const ParticleStore& particles, std::uint64_t step, float deltaTime) {
+    if (!empty() && step != getNewestStep() + 1) {
+        clear();
+    }
+
+    if (!m_storage) {
+        m_storage = std::make_unique_for_overwrite<std::uint8_t[]>(m_memoryBudget);
+        m_storageSize = m_memoryBudget;
+    }
+
+    capture(particles, m_captured);
+
+    // Deltas need the same particles in the same order as the step before
+    bool keyframe{empty() || m_stepsSinceKeyframe + 1 >= m_keyframeInterval
+                  || m_captured.ids != m_newest.ids || m_captured.masses != m_newest.masses};
+
+    if (!keyframe) {
+        encodeDelta(m_newest, m_captured, deltaTime, m_bytes);
+
+        // The newest keyframe and its deltas fill the budget, a new group starts
+        if (store(step, deltaTime, false)) {
+            ++m_stepsSinceKeyframe;
+        } else {
+            clear();
+            keyframe = true;
+        }
+    }
+
+    if (keyframe) {
+        encodeKeyframe(m_captured, m_bytes);
+        m_stepsSinceKeyframe = 0;
+
+        // A single keyframe over the budget, nothing can be kept
+        if (!store(step, deltaTime, true)) {
+            clear();
+        }
+    }
+
+    std::swap(m_newest, m_captured);
+}
+
+void HistoryBuffer::restore(std::uint64_t step, ParticleStore& particles) {
+    const State& state{decode(step)};
+
+    m_restoredParticles.clear();
+    m_restoredParticles.reserve(state.size());
+    m_restoredHandles.resize(state.size());
+
+    for (std::size_t i = 0; i < state.size(); ++i) {
+        const Eigen::Vector2f velocity{std::bit_cast<float>(state.velocityX[i]), std::bit_cast<float>(state.velocityY[i])};
+
+        m_restoredParticles.emplace_back(state.masses[i], velocity);
+        m_restoredParticles.back().restoreCoordinates(std::bit_cast<float>(state.x[i]), std::bit_cast<float>(state.y[i]));
+        m_restoredHandles[i] = ParticleHandle::fromId(state.ids[i]);
+    }
+
+    particles.replace(m_restoredParticles, m_restoredHandles);
+}
+
+void HistoryBuffer::truncateAfter(std::uint64_t step) {
+    const std::size_t index{findEntry(step)};
+    m_newest = decode(step);
+
+    // The bytes after the newest entry are free again
+    while (m_nbEntries > index + 1) {
+        const Entry& entry{getEntry(m_nbEntries - 1)};
+        m_nbKeyframes -= entry.keyframe ? 1 : 0;
+        m_memoryUsage -= getEntrySize(entry);
+        --m_nbEntries;
+    }
+
+    std::size_t keyframeIndex{index};
+
+    while (!getEntry(keyframeIndex).keyframe) {
+        --keyframeIndex;
+    }
+
+    m_stepsSinceKeyframe = static_cast<int>(index - keyframeIndex);
+}
+
+void HistoryBuffer::clear() {
+    m_firstEntry = 0;
+    m_nbEntries = 0;
+    m_nbKeyframes = 0;
+    m_memoryUsage = 0;
+    m_stepsSinceKeyframe = 0;
+    m_cursorValid = false;
+}
+
+void HistoryBuffer::setMemoryBudget(std::size_t bytes) {
+    m_memoryBudget = bytes;
+
+    // A smaller budget keeps the storage, the oldest steps are dropped at the next record
+    if (m_memoryBudget > m_storageSize) {
+        clear();
+        m_storage.reset();
+        m_storageSize = 0;
+    }
+}
+
+void HistoryBuffer::capture(const ParticleStore& particles, State& state) const {
+    state.resize(particles.size());
+
+    for (std::size_t i = 0; i < particles.size(); ++i) {
+        const Particle& particle{particles[i]};
+        const SDL_FRect rect{particle.getParticle()};
+        const Eigen::Vector2f velocity{particle.getVelocity()};
+
+        state.ids[i] = particles.getHandle(i).getId();
+        state.masses[i] = particle.getMass();
+        state.x[i] = std::bit_cast<std::uint32_t>(rect.x);
+        state.y[i] = std::bit_cast<std::uint32_t>(rect.y);
+        state.velocityX[i] = std::bit_cast<std::uint32_t>(velocity(0));
+        state.velocityY[i] = std::bit_cast<std::uint32_t>(velocity(1));
+    }
+}
+
+void HistoryBuffer::encodeKeyframe(const State& state, std::vector<std::uint8_t>& bytes) const {
+    const std::uint64_t nbParticles{state.size()};
+
+    bytes.clear();
+    bytes.insert(bytes.end(), reinterpret_cast<const std::uint8_t*>(&nbParticles), reinterpret_cast<const std::uint8_t*>(&nbParticles) + sizeof(nbParticles));
+    appendArray(bytes, state.ids);
+    appendArray(bytes, state.masses);
+    appendArray(bytes, state.x);
+    appendArray(bytes, state.y);
+    appendArray(bytes, state.velocityX);
+    appendArray(bytes, state.velocityY);
+}
+
+void HistoryBuffer::encodeDelta(const State& previous, const State& state, float deltaTime, std::vector<std::uint8_t>& bytes) const {
+    bytes.clear();
+
+    // Only the particles that differ from their prediction are written, after the number of those skipped before them
+    std::uint64_t nbSkipped{0};
+
+    for (std::size_t i = 0; i < state.size(); ++i) {
+        const std::uint32_t predictedX{predictPosition(previous.x[i], previous.velocityX[i], deltaTime)};
+        const std::uint32_t predictedY{predictPosition(previous.y[i], previous.velocityY[i], deltaTime)};
+
+        if (state.x[i] == predictedX && state.y[i] == predictedY
+            && state.velocityX[i] == previous.velocityX[i] && state.velocityY[i] == previous.velocityY[i]) {
+            ++nbSkipped;
+            continue;
+        }
+
+        Varint::append(bytes, nbSkipped);
+        nbSkipped = 0;
+
+        appendResidual(bytes, state.x[i], predictedX);
+        appendResidual(bytes, state.y[i], predictedY);
+        appendResidual(bytes, state.velocityX[i], previous.velocityX[i]);
+        appendResidual(bytes, state.velocityY[i], previous.velocityY[i]);
+    }
+}
+
+void HistoryBuffer::decodeKeyframe(const Entry& entry, State& state) const {
+    std::uint64_t nbParticles;
+    std::memcpy(&nbParticles, m_storage.get() + entry.offset, sizeof(nbParticles));
+
+    state.resize(nbParticles);
+
+    const std::uint8_t* data{m_storage.get() + entry.offset + sizeof(nbParticles)};
+    readArray(data, state.ids);
+    readArray(data, state.masses);
+    readArray(data, state.x);
+    readArray(data, state.y);
+    readArray(data, state.velocityX);
+    readArray(data, state.velocityY);
+}
+
+void HistoryBuffer::decodeDelta(const Entry& entry, State& state) const {
+    const std::uint8_t* data{m_storage.get() + entry.offset};
+    const std::uint8_t* end{data + entry.size};
+    const float deltaTime{entry.deltaTime};
+
+    // In place: the prediction of the position uses the velocity of the previous step
+    std::size_t i{0};
+
+    while (data != end) {
+        std::uint64_t nbSkipped;
+
+        if (!Varint::read(data, end, nbSkipped) || nbSkipped >= state.size() - i) {
+            throw HistoryError("A history delta is corrupted");
+        }
+
+        for (const std::size_t skipEnd = i + nbSkipped; i < skipEnd; ++i) {
+            state.x[i] = predictPosition(state.x[i], state.velocityX[i], deltaTime);
+            state.y[i] = predictPosition(state.y[i], state.velocityY[i], deltaTime);
+        }
+
+        state.x[i] = readResidual(data, end, predictPosition(state.x[i], state.velocityX[i], deltaTime));
+        state.y[i] = readResidual(data, end, predictPosition(state.y[i], state.velocityY[i], deltaTime));
+        state.velocityX[i] = readResidual(data, end, state.velocityX[i]);
+        state.velocityY[i] = readResidual(data, end, state.velocityY[i]);
+        ++i;
+    }
+
+    for (; i < state.size(); ++i) {
+        state.x[i] = predictPosition(state.x[i], state.velocityX[i], deltaTime);
+        state.y[i] = predictPosition(state.y[i], state.velocityY[i], deltaTime);
+    }
+}
+
+const HistoryBuffer::State& HistoryBuffer::decode(std::uint64_t step) {
+    const std::size_t index{findEntry(step)};
+    std::size_t keyframeIndex{index};
+
+    while (!getEntry(keyframeIndex).keyframe) {
+        --keyframeIndex;
+    }
+
+    std::size_t next;
+
+    if (m_cursorValid && m_cursorStep >= getEntry(keyframeIndex).step && m_cursorStep <= step) {
+        next = findEntry(m_cursorStep) + 1;
+    } else {
+        decodeKeyframe(getEntry(keyframeIndex), m_cursor);
+        next = keyframeIndex + 1;
+    }
+
+    for (; next <= index; ++next) {
+        decodeDelta(getEntry(next), m_cursor);
+    }
+
+    m_cursorStep = step;
+    m_cursorValid = true;
+    return m_cursor;
+}
+
+bool HistoryBuffer::store(std::uint64_t step, float deltaTime, bool keyframe) {
+    const std::size_t size{m_bytes.size()};
+    std::size_t offset{0};
+
+    // A delta can't outlive its keyframe, so the newest group is only dropped for a new keyframe
+    while (m_memoryUsage + sizeof(Entry) + size > m_memoryBudget || !findFreeBytes(size, offset)) {
+        if (m_nbKeyframes == 0 || (!keyframe && m_nbKeyframes == 1)) {
+            return false;
+        }
+
+        dropOldestKeyframe();
+    }
+
+    std::memcpy(m_storage.get() + offset, m_bytes.data(), size);
+    pushEntry(Entry{step, deltaTime, keyframe, offset, size});
+    m_nbKeyframes += keyframe ? 1 : 0;
+    m_memoryUsage += sizeof(Entry) + size;
+    return true;
+}
+
+bool HistoryBuffer::findFreeBytes(std::size_t size, std::size_t& offset) const {
+    if (size > m_storageSize) {
+        return false;
+    }
+
+    if (empty()) {
+        offset = 0;
+        return true;
+    }
+
+    // The entries are written one after the other, the oldest one is a keyframe so it is never empty
+    const Entry& newest{getEntry(m_nbEntries - 1)};
+    const std::size_t oldestOffset{getEntry(0).offset};
+    const std::size_t newestEnd{newest.offset + newest.size};
+
+    if (oldestOffset < newestEnd) {
+        // The live bytes are contiguous, either after them or wrapped to the start of the storage
+        if (newestEnd + size <= m_storageSize) {
+            offset = newestEnd;
+            return true;
+        }
+
+        if (size <= oldestOffset) {
+            offset = 0;
+            return true;
+        }
+
+        return false;
+    }
+
+    // The live bytes already wrapped, the free ones are between the newest and the oldest entry
+    if (newestEnd + size <= oldestOffset) {
+        offset = newestEnd;
+        return true;
+    }
+
+    return false;
+}
+
+std::size_t HistoryBuffer::findEntry(std::uint64_t step) const {
+    // The recorded steps are consecutive
+    if (empty() || step < getOldestStep() || step > getNewestStep()) {
+        throw HistoryError("The step is not in the history anymore");
+    }
+
+    return static_cast<std::size_t>(step - getOldestStep());
+}
+
+void HistoryBuffer::pushEntry(const Entry& entry) {
+    // Unrolled to the front before growing
+    if (m_nbEntries == m_entries.size()) {
+        std::rotate(m_entries.begin(), m_entries.begin() + static_cast<std::ptrdiff_t>(m_firstEntry), m_entries.end());
+        m_firstEntry = 0;
+        m_entries.resize(std::max<std::size_t>(64, 2 * m_entries.size()));
+    }
+
+    m_entries[(m_firstEntry + m_nbEntries) % m_entries.size()] = entry;
+    ++m_nbEntries;
+}
+
+void HistoryBuffer::dropOldestKeyframe() {
+    do {
+        const Entry& oldest{getEntry(0)};
+        m_nbKeyframes -= oldest.keyframe ? 1 : 0;
+        m_memoryUsage -= getEntrySize(oldest);
+        m_firstEntry = (m_firstEntry + 1) % m_entries.size();
+        --m_nbEntries;
+    } while (m_nbEntries > 0 && !getEntry(0).keyframe);
+}
@@ -0,0 +1,164 @@
+#include <SDL3/SDL.h>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "Eigen/Dense"
+
+#include "initialConditions.h"
+#include "simulationErrors.h"
+#include "map.h"
+#include "particle.h"
+#include "philox.h"
+#include "threadPool.h"
+
+namespace {
+    /// Projected Plummer sphere of scale radius a: the mass within R is R^2 / (R^2 + a^2), inverted here
+    Eigen::Vector2f plummerPosition(ParticleRandom& random, float scaleRadius, float maxRadius) {
+        const float maxFraction{maxRadius * maxRadius / (maxRadius * maxRadius + scaleRadius * scaleRadius)};
+        const float fraction{random.uniform() * maxFraction};
+        const float radius{scaleRadius * std::sqrt(fraction / (1.0f - fraction))};
+        const float angle{random.uniform(0.0f, 2.0f * static_cast<float>(M_PI))};
+
+        return {radius * std::cos(angle), radius * std::sin(angle)};
+    }
+
+    /// Isotropic Gaussian velocity whose dispersion follows the Plummer profile (1 + R^2 / a^2)^(-1/4)
+    Eigen::Vector2f plummerVelocity(ParticleRandom& random, const Eigen::Vector2f& position, float scaleRadius, float speed) {
+        const float dispersion{speed * std::pow(1.0f + position.squaredNorm() / (scaleRadius * scaleRadius), -0.25f)};
+        return {dispersion * random.normal(), dispersion * random.normal()};
+    }
+}
+
+void InitialConditions::generate(const InitialConditionSettings& settings, const Map& map, std::vector<Particle>& particles) {
+    begin(settings, map, particles);
+    generateSome(map, particles, m_nbParticles);
+}
+
+void InitialConditions::begin(const InitialConditionSettings& settings, const Map& map, std::vector<Particle>& particles) {
+    if (settings.nbParticles < 0) {
+        throw SimulationError("You can't have a negative number of particles");
+    }
+
+    if (settings.minMass < 1 || settings.minMass > settings.maxMass) {
+        throw SimulationError("The mass range is invalid");
+    }
+
+    m_settings = settings;
+    m_philox = Philox{settings.seed};
+    m_nbParticles = static_cast<std::size_t>(settings.nbParticles);
+
+    // The layout depends on the whole population, so every chunk places its particles the same way
+    m_layout.width = map.getWidth();
+    m_layout.height = map.getHeight();
+    m_layout.scale = std::min(m_layout.width, m_layout.height);
+    m_layout.nbColumns = std::max(1, static_cast<int>(std::ceil(std::sqrt(static_cast<float>(m_nbParticles) * m_layout.width / m_layout.height))));
+    m_layout.nbRows = std::max(1, static_cast<int>((m_nbParticles + m_layout.nbColumns - 1) / m_layout.nbColumns));
+    m_layout.cellWidth = m_layout.width / static_cast<float>(m_layout.nbColumns);
+    m_layout.cellHeight = m_layout.height / static_cast<float>(m_layout.nbRows);
+
+    particles.clear();
+    particles.reserve(m_nbParticles);
+}
+
+bool InitialConditions::generateSome(const Map& map, std::vector<Particle>& particles, std::size_t count) {
+    const std::size_t first{particles.size()};
+    const std::size_t nbDraws{std::min(count, m_nbParticles - first)};
+
+    m_draws.resize(nbDraws);
+
+    m_threadPool.parallelFor(nbDraws, [&](std::size_t begin, std::size_t end, unsigned) {
+        for (std::size_t k = begin; k < end; ++k) {
+            m_draws[k] = drawParticle(first + k);
+        }
+    });
+
+    // The particle size is only known once built, the center becomes the top left corner here
+    for (const Draw& draw : m_draws) {
+        particles.emplace_back(draw.mass, Eigen::Vector2f{draw.velocityX, draw.velocityY});
+        Particle& particle{particles.back()};
+
+        const float radius{particle.getParticle().w / 2.0f};
+        particle.setCoordinates(map, draw.x - radius, draw.y - radius);
+    }
+
+    return particles.size() == m_nbParticles;
+}
+
+InitialConditions::Draw InitialConditions::drawParticle(std::size_t i) const {
+    const InitialConditionSettings& settings{m_settings};
+    const Layout& layout{m_layout};
+    const Eigen::Vector2f mapCenter{layout.width / 2.0f, layout.height / 2.0f};
+
+    ParticleRandom random{m_philox, i};
+
+    const int mass{random.uniformInt(settings.minMass, settings.maxMass)};
+    Eigen::Vector2f center{mapCenter};
+    Eigen::Vector2f velocity{0.0f, 0.0f};
+
+    switch (settings.type) {
+        case InitialCondition::lattice: {
+            center = {(static_cast<float>(i % layout.nbColumns) + 0.5f) * layout.cellWidth,
+                      (static_cast<float>(i / layout.nbColumns) + 0.5f) * layout.cellHeight};
+
+            const float speed{random.uniform(0.0f, settings.speed)};
+            const float angle{random.uniform(0.0f, 2.0f * static_cast<float>(M_PI))};
+            velocity = {speed * std::cos(angle), speed * std::sin(angle)};
+            break;
+        }
+        case InitialCondition::plummer: {
+            const float scaleRadius{layout.scale / 10.0f};
+            const Eigen::Vector2f position{plummerPosition(random, scaleRadius, layout.scale / 2.0f)};
+
+            center += position;
+            velocity = plummerVelocity(random, position, scaleRadius, settings.speed);
+            break;
+        }
+        case InitialCondition::exponentialDisk: {
+            // Surface density exp(-R / Rd): R follows a Gamma(2, Rd) law, redrawn past the map
+            const float scaleLength{layout.scale / 12.0f};
+            float radius;
+            do {
+                radius = -scaleLength * std::log((1.0f - random.uniform()) * (1.0f - random.uniform()));
+            } while (radius > layout.scale / 2.0f);
+
+            const float angle{random.uniform(0.0f, 2.0f * static_cast<float>(M_PI))};
+            const Eigen::Vector2f direction{std::cos(angle), std::sin(angle)};
+
+            // Solid body in the center, flat past the scale length, plus a cold dispersion
+            const float circularSpeed{settings.speed * radius / std::sqrt(radius * radius + scaleLength * scaleLength)};
+            const float dispersion{0.1f * settings.speed};
+
+            center += radius * direction;
+            velocity = circularSpeed * Eigen::Vector2f{-direction(1), direction(0)}
+                     + dispersion * Eigen::Vector2f{random.normal(), random.normal()};
+            break;
+        }
+        case InitialCondition::collidingClusters: {
+            // Even indices in the left cluster, odd ones in the right cluster
+            const float side{i % 2 == 0 ? -1.0f : 1.0f};
+            const float scaleRadius{layout.scale / 20.0f};
+            const Eigen::Vector2f position{plummerPosition(random, scaleRadius, layout.scale / 5.0f)};
+
+            center += side * Eigen::Vector2f{layout.scale / 4.0f, layout.scale / 20.0f} + position;
+            velocity = Eigen::Vector2f{-side * settings.speed / 2.0f, 0.0f}
+                     + plummerVelocity(random, position, scaleRadius, 0.2f * settings.speed);
+            break;
+        }
+        case InitialCondition::thermalGas: {
+            // Jitter within the slack of the lattice cell so that the particles still don't overlap
+            const float diameter{Particle::getDiameter(mass)};
+            const float slackX{std::max(0.0f, layout.cellWidth - diameter) / 2.0f};
+            const float slackY{std::max(0.0f, layout.cellHeight - diameter) / 2.0f};
+
+            center = {(static_cast<float>(i % layout.nbColumns) + 0.5f) * layout.cellWidth + random.uniform(-slackX, slackX),
+                      (static_cast<float>(i / layout.nbColumns) + 0.5f) * layout.cellHeight + random.uniform(-slackY, slackY)};
+
+            // Maxwell-Boltzmann: each component is Gaussian with variance kT / m
+            const float dispersion{std::sqrt(settings.temperature / static_cast<float>(mass))};
+            velocity = {dispersion * random.normal(), dispersion * random.normal()};
+            break;
+        }
+    }
+
+    return Draw{mass, center(0), center(1), velocity(0), velocity(1)};
+}
@@ -0,0 +1,55 @@
+#include <SDL3/SDL.h>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "jobScheduler.h"
+
+void JobScheduler::submit(std::string name, Slice slice, Progress progress) {
+    m_jobs.push_back(Job{std::move(name), std::move(slice), std::move(progress)});
+}
+
+void JobScheduler::run(float budgetMs) {
+    const Uint64 start{SDL_GetPerformanceCounter()};
+    const double ticksPerMs{static_cast<double>(SDL_GetPerformanceFrequency()) / 1.0e3};
+
+    auto elapsedMs = [start, ticksPerMs]() -> double {
+        return static_cast<double>(SDL_GetPerformanceCounter() - start) / ticksPerMs;
+    };
+
+    while (!m_jobs.empty()) {
+        if (m_jobs.front().slice()) {
+            m_jobs.pop_front();
+        }
+
+        if (elapsedMs() >= budgetMs) {
+            break;
+        }
+    }
+
+    m_lastRunMs = static_cast<float>(elapsedMs());
+}
+
+bool JobScheduler::contains(std::string_view name) const {
+    for (const Job& job : m_jobs) {
+        if (job.name == name) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+const std::string& JobScheduler::getCurrentName() const {
+    static const std::string idle;
+
+    return m_jobs.empty() ? idle : m_jobs.front().name;
+}
+
+float JobScheduler::getCurrentProgress() const {
+    if (m_jobs.empty() || !m_jobs.front().progress) {
+        return -1.0f;
+    }
+
+    return m_jobs.front().progress();
+}
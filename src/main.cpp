@@ -1,13 +1,218 @@
 #include <SDL3/SDL.h>
 #include <SDL3/SDL_main.h>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
 #include <exception>
+#include <filesystem>
+#include <string>
+#include <vector>
 #include "version.h"
 
 #include "simulation.h"
+#include "ensembleRunner.h"
+#include "remoteProtocol.h"
+#include "sharedState.h"
+#include "allocationTracker.h"
 
-int main() {
+int main(int argc, char* argv[]) {
     try {
+        // Headless parameter sweep: Gravity --ensemble <spec> <output.csv> [nbWorkers]
+        if (argc >= 4 && std::strcmp(argv[1], "--ensemble") == 0) {
+            EnsembleRunner ensembleRunner(argv[2]);
+            const unsigned nbWorkers{argc >= 5 ? static_cast<unsigned>(std::strtoul(argv[4], nullptr, 10)) : 0u};
+
+            SDL_Log("Running %zu simulations into %s", ensembleRunner.getNbRuns(), argv[3]);
+            ensembleRunner.run(argv[3], nbWorkers);
+            return 0;
+        }
+
+        // Steady-state heap check: Gravity --allocation-check [nbSteps], fails if a warmed-up step allocates
+        if (argc >= 2 && std::strcmp(argv[1], "--allocation-check") == 0) {
+            if (!AllocationTracker::enabled) {
+                SDL_Log("Allocations are not counted, build with GRAVITY_TRACK_ALLOCATIONS");
+                return -1;
+            }
+
+            const int nbSteps{argc >= 3 ? std::atoi(argv[2]) : 1000};
+
+            // One case per pair interaction, then the optional parts of the step on hard spheres
+            struct AllocationCase {
+                const char* name;
+                SimulationSettings settings;
+            };
+
+            std::vector<AllocationCase> cases;
+            const char* interactionNames[]{"hard spheres", "soft repulsion", "Lennard-Jones", "merging"};
+
+            for (PairInteraction interaction : {PairInteraction::hardSphere, PairInteraction::softRepulsion,
+                                                PairInteraction::lennardJones, PairInteraction::merging}) {
+                cases.push_back({interactionNames[static_cast<int>(interaction)], SimulationSettings{}});
+                cases.back().settings.pairInteraction = interaction;
+            }
+
+            cases.push_back({"gravity (fast multipole)", SimulationSettings{}});
+            cases.back().settings.gravity = true;
+
+            cases.push_back({"unbounded (sparse grid)", SimulationSettings{}});
+            cases.back().settings.unbounded = true;
+
+            // Obstacles come from a bitmap: walls with gaps, written like a user drawing
+            const std::string obstacleBitmap{(std::filesystem::temp_directory_path() / "gravity_allocation_check.bmp").string()};
+            SDL_Surface* surface{SDL_CreateSurface(30, 30, SDL_PIXELFORMAT_RGB24)};
+
+            if (!surface) {
+                SDL_Log("Creating the obstacle bitmap failed: %s", SDL_GetError());
+                return -1;
+            }
+
+            const SDL_Rect walls[]{{9, 0, 2, 24}, {19, 6, 2, 24}};
+            bool written{SDL_FillSurfaceRect(surface, nullptr, SDL_MapSurfaceRGB(surface, 255, 255, 255))};
+
+            for (const SDL_Rect& wall : walls) {
+                written = written && SDL_FillSurfaceRect(surface, &wall, SDL_MapSurfaceRGB(surface, 0, 0, 0));
+            }
+
+            written = written && SDL_SaveBMP(surface, obstacleBitmap.c_str());
+            SDL_DestroySurface(surface);
+
+            if (!written) {
+                SDL_Log("Writing the obstacle bitmap failed: %s", SDL_GetError());
+                return -1;
+            }
+
+            cases.push_back({"obstacles (distance field)", SimulationSettings{}});
+            cases.back().settings.obstacleBitmap = obstacleBitmap;
+
+            int nbFailures{0};
+
+            for (AllocationCase& allocationCase : cases) {
+                allocationCase.settings.nbParticles = 1000;
+                allocationCase.settings.nbThreads = 0;
+
+                Simulation simulation(allocationCase.settings);
+                const std::uint64_t nbAllocations{simulation.countSteadyStateAllocations(3000, nbSteps, 1.0f / 120.0f)};
+
+                SDL_Log("%s: %llu allocations in %d steps", allocationCase.name, static_cast<unsigned long long>(nbAllocations), nbSteps);
+                nbFailures += nbAllocations > 0 ? 1 : 0;
+            }
+
+            std::filesystem::remove(obstacleBitmap);
+
+            return nbFailures > 0 ? 1 : 0;
+        }
+
+        // Long-range gravity check: Gravity --fmm-check [nbParticles] [order] [tolerance], fails if a force is off by more
+        if (argc >= 2 && std::strcmp(argv[1], "--fmm-check") == 0) {
+            const int nbParticles{argc >= 3 ? std::atoi(argv[2]) : 20000};
+            const int order{argc >= 4 ? std::atoi(argv[3]) : 16};
+            const double tolerance{argc >= 5 ? std::strtod(argv[4], nullptr) : 1e-6};
+
+            ThreadPool threadPool(0);
+            Map map(300, 300, 50);
+            InitialConditions initialConditions(threadPool);
+            InitialConditionSettings settings;
+            settings.type = InitialCondition::plummer;
+            settings.nbParticles = nbParticles;
+
+            std::vector<Particle> particles;
+            initialConditions.generate(settings, map, particles);
+
+            FastMultipole fastMultipole(threadPool);
+            fastMultipole.setOrder(order);
+
+            // Every particle is checked, the exact sum is the O(N^2) reference
+            const Uint64 start{SDL_GetPerformanceCounter()};
+            fastMultipole.compute(particles, 1.0e3f);
+            const Uint64 middle{SDL_GetPerformanceCounter()};
+            const MultipoleError error{fastMultipole.measureError(particles, particles.size())};
+            const Uint64 end{SDL_GetPerformanceCounter()};
+
+            const double frequency{static_cast<double>(SDL_GetPerformanceFrequency())};
+            SDL_Log("%zu particles, order %d: fast multipole %.1f ms (%zu boxes, %zu M2L, %zu P2P), exact sum %.1f ms",
+                    particles.size(), fastMultipole.getOrder(), (middle - start) * 1.0e3 / frequency, fastMultipole.getNbNodes(),
+                    fastMultipole.getNbM2L(), fastMultipole.getNbP2P(), (end - middle) * 1.0e3 / frequency);
+            SDL_Log("Relative force error: max %.2e, rms %.2e (tolerance %.1e)", error.maxRelativeError,
+                    error.rmsRelativeError, tolerance);
+
+            return error.maxRelativeError > tolerance ? 1 : 0;
+        }
+
+        // Windowless producer of the shared state: Gravity --export [nbParticles] [nbSteps], see examples/checkSharedState.sh
+        if (argc >= 2 && std::strcmp(argv[1], "--export") == 0) {
+            SimulationSettings settings;
+            settings.nbParticles = argc >= 3 ? std::atoi(argv[2]) : 1000;
+            settings.nbThreads = 0;
+            settings.sharedStateName = SharedState::defaultName;
+
+            const int nbSteps{argc >= 4 ? std::atoi(argv[3]) : 7200};
+
+            Simulation simulation(settings);
+            SDL_Log("Exporting %d steps of %d particles to %s", nbSteps, settings.nbParticles, SharedState::defaultName);
+
+            // About 120 steps per second, so that readers often copy the same step twice
+            for (int i = 0; i < nbSteps; ++i) {
+                simulation.runHeadless(1, 1.0f / 120.0f);
+                SDL_Delay(8);
+            }
+
+            return 0;
+        }
+
+        // Headless movie: Gravity --record <directory> [nbSteps] [nbParticles] [recordInterval], frames of the whole map height
+        if (argc >= 3 && std::strcmp(argv[1], "--record") == 0) {
+            SimulationSettings settings;
+            settings.framesDirectory = argv[2];
+            settings.nbParticles = argc >= 5 ? std::atoi(argv[4]) : 1000;
+            settings.recordInterval = argc >= 6 ? std::atoi(argv[5]) : 1;
+            settings.nbThreads = 0;
+
+            const int nbSteps{argc >= 4 ? std::atoi(argv[3]) : 600};
+
+            Simulation simulation(settings);
+            SDL_Log("Recording %d steps of %d particles into %s", nbSteps, settings.nbParticles, argv[2]);
+            simulation.runHeadless(nbSteps, 1.0f / 120.0f);
+            return 0;
+        }
+
+        // Remote viewing: Gravity --server [port] [nbParticles] [initialCondition] [seed], then Gravity --client [host] [port]
+        if (argc >= 2 && std::strcmp(argv[1], "--server") == 0) {
+            const std::uint16_t port{argc >= 3 ? static_cast<std::uint16_t>(std::strtoul(argv[2], nullptr, 10)) : RemoteProtocol::defaultPort};
+
+            SimulationSettings settings;
+            settings.nbParticles = argc >= 4 ? std::atoi(argv[3]) : 1000;
+            settings.seed = argc >= 6 ? std::strtoull(argv[5], nullptr, 10) : 0;
+            settings.nbThreads = 0;
+
+            // Same names and order as InitialCondition
+            const char* initialConditionNames[]{"lattice", "plummer", "disk", "clusters", "gas"};
+            const char* initialConditionName{argc >= 5 ? argv[4] : "lattice"};
+
+            for (int type = 0; type < 5; ++type) {
+                if (std::strcmp(initialConditionName, initialConditionNames[type]) == 0) {
+                    settings.initialCondition = static_cast<InitialCondition>(type);
+                }
+            }
+
+            if (!settings.initialCondition) {
+                SDL_Log("Unknown initial condition %s, expected lattice, plummer, disk, clusters or gas", initialConditionName);
+                return -1;
+            }
+
+            Simulation simulation(settings);
+            simulation.runServer(port);
+            return 0;
+        }
+
         Simulation simulation("Gravity Simulation", "Axel LT");
+
+        if (argc >= 2 && std::strcmp(argv[1], "--client") == 0) {
+            const char* host{argc >= 3 ? argv[2] : "localhost"};
+            const std::uint16_t port{argc >= 4 ? static_cast<std::uint16_t>(std::strtoul(argv[3], nullptr, 10)) : RemoteProtocol::defaultPort};
+
+            simulation.connectToServer(host, port);
+        }
+
         simulation.run();
     }
     catch (const std::exception& e) {
@@ -1,4 +1,5 @@
 #include <SDL3/SDL.h>
+#include <algorithm>
 
 #include "map.h"
 #include "mapErrors.h"
@@ -10,24 +11,17 @@ void Map::setTexture(SDL_Renderer* renderer) {
         throw MapError("Map texture creation failed: ", SDL_GetError());
     }
 
+    updateTexture(renderer);
+}
+
+void Map::updateTexture(SDL_Renderer* renderer) {
     if(!SDL_SetRenderTarget(renderer, m_texture)) {
         throw MapError("Setting the render target for map texture creation failed: ", SDL_GetError());
     }
 
     for (int col = 0; col < m_nbColumns; ++col) {
         for (int row = 0; row < m_nbRows; ++row) {
-            bool isColored{(col + row) % 2 == 0};
-            int rgba{isColored ? 50 : 150};
-            
-            if (!SDL_SetRenderDrawColor(renderer, rgba, rgba, rgba, 255)) {
-                throw MapError("Setting the render draw color for map texture creation failed: ", SDL_GetError());
-            }
-
-            const SDL_FRect rect{col * m_size, row * m_size, m_size, m_size};
-
-            if (!SDL_RenderFillRect(renderer, &rect)) {
-                throw MapError("Filling a square for map texture creation failed: ", SDL_GetError());
-            }
+            drawSquare(renderer, col, row);
         }
     }
 
@@ -36,6 +30,65 @@ void Map::setTexture(SDL_Renderer* renderer) {
     }
 }
 
+void Map::updateTexture(SDL_Renderer* renderer, int column, int row) {
+    if(!SDL_SetRenderTarget(renderer, m_texture)) {
+        throw MapError("Setting the render target for map texture update failed: ", SDL_GetError());
+    }
+
+    drawSquare(renderer, column, row);
+
+    if (!SDL_SetRenderTarget(renderer, nullptr)) {
+        throw MapError("Setting the render target back to the screen during map texture update failed: ", SDL_GetError());
+    }
+}
+
+void Map::drawSquare(SDL_Renderer* renderer, int column, int row) {
+    bool isColored{(column + row) % 2 == 0};
+    int rgba{isColored ? 50 : 150};
+
+    bool drawColor{isSolid(column, row) ? SDL_SetRenderDrawColor(renderer, 140, 60, 30, 255)
+                                         : SDL_SetRenderDrawColor(renderer, rgba, rgba, rgba, 255)};
+
+    if (!drawColor) {
+        throw MapError("Setting the render draw color for map texture creation failed: ", SDL_GetError());
+    }
+
+    const SDL_FRect rect{column * m_size, row * m_size, m_size, m_size};
+
+    if (!SDL_RenderFillRect(renderer, &rect)) {
+        throw MapError("Filling a square for map texture creation failed: ", SDL_GetError());
+    }
+}
+
+bool Map::hasSolidCells() const {
+    return std::find(m_solidCells.begin(), m_solidCells.end(), 1) != m_solidCells.end();
+}
+
+void Map::loadSolidCells(const char* path) {
+    SDL_Surface* surface{SDL_LoadBMP(path)};
+
+    if (!surface) {
+        throw MapError("Loading the obstacle bitmap failed: ", SDL_GetError());
+    }
+
+    for (int row = 0; row < getNbRows(); ++row) {
+        for (int col = 0; col < getNbColumns(); ++col) {
+            const int x{static_cast<int>((col + 0.5f) * surface->w / m_nbColumns)};
+            const int y{static_cast<int>((row + 0.5f) * surface->h / m_nbRows)};
+            Uint8 r, g, b, a;
+
+            if (!SDL_ReadSurfacePixel(surface, x, y, &r, &g, &b, &a)) {
+                SDL_DestroySurface(surface);
+                throw MapError("Reading a pixel of the obstacle bitmap failed: ", SDL_GetError());
+            }
+
+            setSolid(col, row, r + g + b < 3 * 128);
+        }
+    }
+
+    SDL_DestroySurface(surface);
+}
+
 void Map::render(SDL_Renderer *renderer, const SDL_FRect gameViewport) {
     if (!SDL_RenderTexture(renderer, m_texture, &gameViewport, nullptr)) {
         throw MapError("Rendering the map texture failed: ", SDL_GetError());
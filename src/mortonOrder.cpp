@@ -0,0 +1,95 @@
+#include <SDL3/SDL.h>
+#include <algorithm>
+#include <array>
+#include <vector>
+#include "Eigen/Dense"
+
+#include "mortonOrder.h"
+#include "map.h"
+#include "particle.h"
+#include "threadPool.h"
+
+std::uint32_t MortonOrder::interleave(std::uint16_t x, std::uint16_t y) {
+    // Spread the 16 bits of a coordinate on the even bits of a 32 bits word
+    auto spread = [](std::uint32_t value) -> std::uint32_t {
+        value = (value | (value << 8)) & 0x00FF00FFu;
+        value = (value | (value << 4)) & 0x0F0F0F0Fu;
+        value = (value | (value << 2)) & 0x33333333u;
+        value = (value | (value << 1)) & 0x55555555u;
+        return value;
+    };
+
+    return spread(x) | (spread(y) << 1);
+}
+
+const std::vector<std::uint32_t>& MortonOrder::computeOrder(const std::vector<Particle>& particles, const Map& map) {
+    const std::size_t nbParticles{particles.size()};
+
+    m_keys.resize(nbParticles);
+    m_order.resize(nbParticles);
+    m_keysScratch.resize(nbParticles);
+    m_orderScratch.resize(nbParticles);
+
+    // The keys span the map, or the box around the particles when they can leave it
+    Eigen::Vector2f origin{0.0f, 0.0f};
+    Eigen::Vector2f size{map.getWidth(), map.getHeight()};
+
+    if (map.isUnbounded() && nbParticles > 0) {
+        Eigen::Vector2f min{particles[0].getCenter()};
+        Eigen::Vector2f max{min};
+
+        for (const Particle& particle : particles) {
+            min = min.cwiseMin(particle.getCenter());
+            max = max.cwiseMax(particle.getCenter());
+        }
+
+        origin = min;
+        size = (max - min).cwiseMax(1.0f);
+    }
+
+    const float scaleX{65535.0f / size(0)};
+    const float scaleY{65535.0f / size(1)};
+
+    m_threadPool.parallelFor(nbParticles, [&](std::size_t begin, std::size_t end, unsigned) {
+        for (std::size_t i = begin; i < end; ++i) {
+            const SDL_FRect rect{particles[i].getParticle()};
+            const float x{std::clamp((rect.x + rect.w / 2.0f - origin(0)) * scaleX, 0.0f, 65535.0f)};
+            const float y{std::clamp((rect.y + rect.h / 2.0f - origin(1)) * scaleY, 0.0f, 65535.0f)};
+
+            m_keys[i] = interleave(static_cast<std::uint16_t>(x), static_cast<std::uint16_t>(y));
+            m_order[i] = static_cast<std::uint32_t>(i);
+        }
+    });
+
+    // LSD radix sort, 4 passes of 8 bits, stable so equal keys keep their current order
+    for (int shift = 0; shift < 32; shift += 8) {
+        std::array<std::uint32_t, 256> offsets{};
+
+        for (std::size_t i = 0; i < nbParticles; ++i) {
+            ++offsets[(m_keys[i] >> shift) & 0xFFu];
+        }
+
+        // All the keys share this digit, the pass would not move anything
+        if (offsets[(m_keys.empty() ? 0 : m_keys[0] >> shift) & 0xFFu] == nbParticles) {
+            continue;
+        }
+
+        std::uint32_t sum{0};
+        for (std::uint32_t& offset : offsets) {
+            const std::uint32_t count{offset};
+            offset = sum;
+            sum += count;
+        }
+
+        for (std::size_t i = 0; i < nbParticles; ++i) {
+            const std::uint32_t destination{offsets[(m_keys[i] >> shift) & 0xFFu]++};
+            m_keysScratch[destination] = m_keys[i];
+            m_orderScratch[destination] = m_order[i];
+        }
+
+        m_keys.swap(m_keysScratch);
+        m_order.swap(m_orderScratch);
+    }
+
+    return m_order;
+}
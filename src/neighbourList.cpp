@@ -0,0 +1,156 @@
+#include <SDL3/SDL.h>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "Eigen/Dense"
+
+#include "neighbourList.h"
+#include "map.h"
+#include "particle.h"
+#include "sparseGrid.h"
+
+bool NeighbourList::update(const std::vector<Particle>& particles, const Map& map, PairInteraction interaction) {
+    ++m_nbUpdates;
+
+    const bool sameParticles{m_referenceCenters.size() == particles.size()};
+
+    if (m_valid && sameParticles && interaction == m_interaction && !needsRebuild(particles)) {
+        return false;
+    }
+
+    build(particles, map, interaction);
+
+    return true;
+}
+
+bool NeighbourList::needsRebuild(const std::vector<Particle>& particles) const {
+    const float maxDisplacementSquared{(m_skin / 2.0f) * (m_skin / 2.0f)};
+
+    for (std::size_t i = 0; i < particles.size(); ++i) {
+        const Eigen::Vector2f displacement{particles[i].getCenter() - m_referenceCenters[i]};
+
+        if (displacement.dot(displacement) > maxDisplacementSquared) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void NeighbourList::build(const std::vector<Particle>& particles, const Map& map, PairInteraction interaction) {
+    const std::size_t nbParticles{particles.size()};
+    const float rangeFactor{Particle::getInteractionRangeFactor(interaction)};
+
+    m_interaction = interaction;
+    m_valid = true;
+    ++m_nbBuilds;
+
+    m_referenceCenters.resize(nbParticles);
+    float maxDiameter{0.0f};
+
+    for (std::size_t i = 0; i < nbParticles; ++i) {
+        m_referenceCenters[i] = particles[i].getCenter();
+        maxDiameter = std::max(maxDiameter, particles[i].getParticle().w);
+    }
+
+    // A pair further apart than one cell can't be in range, so the 3x3 surrounding cells are enough
+    const float cellSize{std::max(maxDiameter * rangeFactor + m_skin, 1.0f)};
+
+    // Half lists, j > i, so each pair is solved once
+    m_offsets.resize(nbParticles + 1);
+    m_neighbours.clear();
+
+    auto addNeighbours = [&](std::size_t i, const std::uint32_t* candidates, const std::uint32_t* candidatesEnd) {
+        const float radius{particles[i].getParticle().w / 2.0f};
+
+        for (const std::uint32_t* candidate = candidates; candidate != candidatesEnd; ++candidate) {
+            const std::uint32_t j{*candidate};
+
+            if (j <= i) {
+                continue;
+            }
+
+            const float cutoff{(radius + particles[j].getParticle().w / 2.0f) * rangeFactor + m_skin};
+            const Eigen::Vector2f deltaPos{m_referenceCenters[j] - m_referenceCenters[i]};
+
+            if (deltaPos.dot(deltaPos) < cutoff * cutoff) {
+                m_neighbours.push_back(j);
+            }
+        }
+    };
+
+    // Open space: a dense grid over the bounding box could be huge, only the occupied cells are stored
+    if (map.isUnbounded()) {
+        m_sparseGrid.build(particles, cellSize);
+
+        const std::vector<std::uint32_t>& cellParticles{m_sparseGrid.getParticles()};
+
+        for (std::size_t i = 0; i < nbParticles; ++i) {
+            m_offsets[i] = static_cast<std::uint32_t>(m_neighbours.size());
+
+            const SparseGrid::Cell& cell{m_sparseGrid.getCells()[m_sparseGrid.getParticleCell(i)]};
+
+            for (int neighbourRow = cell.row - 1; neighbourRow <= cell.row + 1; ++neighbourRow) {
+                for (int neighbourCol = cell.column - 1; neighbourCol <= cell.column + 1; ++neighbourCol) {
+                    if (const SparseGrid::Cell* neighbourCell{m_sparseGrid.findCell(neighbourCol, neighbourRow)}) {
+                        addNeighbours(i, cellParticles.data() + neighbourCell->begin, cellParticles.data() + neighbourCell->end);
+                    }
+                }
+            }
+        }
+
+        m_offsets[nbParticles] = static_cast<std::uint32_t>(m_neighbours.size());
+        return;
+    }
+
+    const int nbColumns{std::max(1, static_cast<int>(std::ceil(map.getWidth() / cellSize)))};
+    const int nbRows{std::max(1, static_cast<int>(std::ceil(map.getHeight() / cellSize)))};
+
+    auto cellCoordinate = [cellSize](float coordinate, int nbCells) -> int {
+        return std::clamp(static_cast<int>(coordinate / cellSize), 0, nbCells - 1);
+    };
+
+    // Counting sort of the particles into the cells
+    m_particleCells.resize(nbParticles);
+    m_cellOffsets.assign(static_cast<std::size_t>(nbColumns) * nbRows + 1, 0);
+
+    for (std::size_t i = 0; i < nbParticles; ++i) {
+        const int col{cellCoordinate(m_referenceCenters[i](0), nbColumns)};
+        const int row{cellCoordinate(m_referenceCenters[i](1), nbRows)};
+
+        m_particleCells[i] = static_cast<std::uint32_t>(row * nbColumns + col);
+        ++m_cellOffsets[m_particleCells[i] + 1];
+    }
+
+    for (std::size_t cell = 1; cell < m_cellOffsets.size(); ++cell) {
+        m_cellOffsets[cell] += m_cellOffsets[cell - 1];
+    }
+
+    m_cellParticles.resize(nbParticles);
+    for (std::size_t i = 0; i < nbParticles; ++i) {
+        m_cellParticles[m_cellOffsets[m_particleCells[i]]++] = static_cast<std::uint32_t>(i);
+    }
+
+    // The scatter moved every offset to the start of the next cell
+    for (std::size_t cell = m_cellOffsets.size() - 1; cell > 0; --cell) {
+        m_cellOffsets[cell] = m_cellOffsets[cell - 1];
+    }
+    m_cellOffsets[0] = 0;
+
+    for (std::size_t i = 0; i < nbParticles; ++i) {
+        m_offsets[i] = static_cast<std::uint32_t>(m_neighbours.size());
+
+        const int col{static_cast<int>(m_particleCells[i] % nbColumns)};
+        const int row{static_cast<int>(m_particleCells[i] / nbColumns)};
+
+        for (int neighbourRow = std::max(0, row - 1); neighbourRow <= std::min(nbRows - 1, row + 1); ++neighbourRow) {
+            for (int neighbourCol = std::max(0, col - 1); neighbourCol <= std::min(nbColumns - 1, col + 1); ++neighbourCol) {
+                const std::size_t cell{static_cast<std::size_t>(neighbourRow) * nbColumns + neighbourCol};
+
+                addNeighbours(i, m_cellParticles.data() + m_cellOffsets[cell], m_cellParticles.data() + m_cellOffsets[cell + 1]);
+            }
+        }
+    }
+
+    m_offsets[nbParticles] = static_cast<std::uint32_t>(m_neighbours.size());
+}
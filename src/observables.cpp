@@ -0,0 +1,103 @@
+#include <cmath>
+#include <vector>
+#include "Eigen/Dense"
+
+#include "observables.h"
+
+void Observables::beginStep(unsigned nbThreads, const Eigen::Vector2f& mapCenter) {
+    m_mapCenter = mapCenter;
+
+    if (m_accumulators.size() != nbThreads) {
+        m_accumulators.resize(nbThreads);
+    }
+
+    for (Accumulator& accumulator : m_accumulators) {
+        accumulator = Accumulator{};
+    }
+}
+
+void Observables::endStep() {
+    CompensatedSum kineticEnergy, potentialEnergy, mass, momentumX, momentumY, massX, massY, angularMomentum;
+    std::array<std::uint32_t, nbHistogramBins> histogram{};
+    std::size_t nbParticles{0};
+
+    // Thread order, so the result doesn't depend on which thread finished first
+    for (const Accumulator& accumulator : m_accumulators) {
+        kineticEnergy.add(accumulator.kineticEnergy.get());
+        potentialEnergy.add(accumulator.potentialEnergy.get());
+        mass.add(accumulator.mass.get());
+        momentumX.add(accumulator.momentumX.get());
+        momentumY.add(accumulator.momentumY.get());
+        massX.add(accumulator.massX.get());
+        massY.add(accumulator.massY.get());
+        angularMomentum.add(accumulator.angularMomentum.get());
+
+        for (int bin = 0; bin < nbHistogramBins; ++bin) {
+            histogram[bin] += accumulator.histogram[bin];
+        }
+        nbParticles += accumulator.nbParticles;
+    }
+
+    m_sample.kineticEnergy = kineticEnergy.get();
+    m_sample.potentialEnergy = potentialEnergy.get();
+    m_sample.totalMass = mass.get();
+    m_sample.momentum = {momentumX.get(), momentumY.get()};
+    m_sample.angularMomentum = angularMomentum.get();
+    m_sample.nbParticles = nbParticles;
+
+    if (m_sample.totalMass > 0.0) {
+        m_sample.centerOfMass = Eigen::Vector2d{massX.get(), massY.get()} / m_sample.totalMass;
+    }
+
+    for (int bin = 0; bin < nbHistogramBins; ++bin) {
+        m_histogram[bin] = static_cast<float>(histogram[bin]);
+    }
+
+    if (!m_hasReference) {
+        m_referenceEnergy = m_sample.getTotalEnergy();
+        m_hasReference = true;
+    }
+
+    m_totalEnergyHistory[m_historyOffset] = static_cast<float>(m_sample.getTotalEnergy());
+    m_momentumHistory[m_historyOffset] = static_cast<float>(m_sample.momentum.norm());
+    m_angularMomentumHistory[m_historyOffset] = static_cast<float>(m_sample.angularMomentum);
+    m_historyOffset = (m_historyOffset + 1) % historySize;
+
+    fitMaxwellBoltzmann();
+}
+
+double Observables::getEnergyDrift() const {
+    if (m_referenceEnergy == 0.0) {
+        return 0.0;
+    }
+
+    return (m_sample.getTotalEnergy() - m_referenceEnergy) / m_referenceEnergy;
+}
+
+void Observables::fitMaxwellBoltzmann() {
+    m_fittedHistogram.fill(0.0f);
+
+    if (m_sample.nbParticles == 0 || m_sample.kineticEnergy <= 0.0) {
+        m_fittedTemperature = 0.0;
+        return;
+    }
+
+    // 2D equipartition: <KE> = kT, the speeds of particles of mass m follow
+    // f(v) = (m v / kT) exp(-m v^2 / 2kT), we fit with the mean mass
+    const double nbParticles{static_cast<double>(m_sample.nbParticles)};
+    m_fittedTemperature = m_sample.kineticEnergy / nbParticles;
+
+    const double meanMass{m_sample.totalMass / nbParticles};
+    const double sigmaSquared{m_fittedTemperature / meanMass};
+    const double binWidth{histogramMaxSpeed / nbHistogramBins};
+
+    auto cumulative = [sigmaSquared](double speed) -> double {
+        return 1.0 - std::exp(-speed * speed / (2.0 * sigmaSquared));
+    };
+
+    for (int bin = 0; bin < nbHistogramBins; ++bin) {
+        // The last bin also holds everything faster than histogramMaxSpeed
+        const double upper{bin == nbHistogramBins - 1 ? 1.0 : cumulative((bin + 1) * binWidth)};
+        m_fittedHistogram[bin] = static_cast<float>(nbParticles * (upper - cumulative(bin * binWidth)));
+    }
+}
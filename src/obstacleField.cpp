@@ -0,0 +1,218 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+#include "Eigen/Dense"
+
+#include "obstacleField.h"
+#include "map.h"
+
+namespace {
+    /// Squared distance of a sample with no feature on its line yet
+    constexpr float infinity{1.0e20f};
+}
+
+void ObstacleField::build(const Map& map) {
+    startBuild(map);
+    continueBuild(std::numeric_limits<std::size_t>::max());
+}
+
+void ObstacleField::startBuild(const Map& map) {
+    m_buildWidth = map.getNbColumns() * samplesPerSquare;
+    m_buildHeight = map.getNbRows() * samplesPerSquare;
+    m_buildSpacing = map.getSquareSize() / samplesPerSquare;
+
+    const std::size_t nbSamples{static_cast<std::size_t>(m_buildWidth) * static_cast<std::size_t>(m_buildHeight)};
+    m_distancesToSolid.resize(nbSamples);
+    m_distancesToFree.resize(nbSamples);
+    m_buildHasObstacles = false;
+
+    for (int j = 0; j < m_buildHeight; ++j) {
+        for (int i = 0; i < m_buildWidth; ++i) {
+            const bool solid{map.isSolid(i / samplesPerSquare, j / samplesPerSquare)};
+            const std::size_t index{static_cast<std::size_t>(j) * m_buildWidth + i};
+
+            m_distancesToSolid[index] = solid ? 0.0f : infinity;
+            m_distancesToFree[index] = solid ? infinity : 0.0f;
+            m_buildHasObstacles = m_buildHasObstacles || solid;
+        }
+    }
+
+    const std::size_t lineLength{static_cast<std::size_t>(std::max(m_buildWidth, m_buildHeight))};
+    m_line.resize(lineLength);
+    m_lineResult.resize(lineLength);
+    m_parabolas.resize(lineLength);
+    m_boundaries.resize(lineLength + 1);
+
+    m_building = true;
+    m_nextLine = 0;
+
+    // Nothing to transform, the empty field is used right away
+    if (!m_buildHasObstacles) {
+        m_nextLine = static_cast<std::size_t>(m_buildWidth + m_buildHeight);
+    }
+}
+
+bool ObstacleField::continueBuild(std::size_t nbLines) {
+    if (!m_building) {
+        return true;
+    }
+
+    // The columns first, then the rows
+    const std::size_t nbBuildLines{static_cast<std::size_t>(m_buildWidth + m_buildHeight)};
+
+    for (std::size_t n = 0; n < nbLines && m_nextLine < nbBuildLines; ++n) {
+        transformLine(m_nextLine);
+        ++m_nextLine;
+    }
+
+    if (m_nextLine < nbBuildLines) {
+        return false;
+    }
+
+    finishBuild();
+    return true;
+}
+
+float ObstacleField::getBuildProgress() const {
+    if (!m_building) {
+        return 1.0f;
+    }
+
+    return static_cast<float>(m_nextLine) / static_cast<float>(m_buildWidth + m_buildHeight);
+}
+
+float ObstacleField::getDistance(const Eigen::Vector2f& point) const {
+    const Patch patch{getPatch(point)};
+
+    return (patch.d00 * (1.0f - patch.fx) + patch.d10 * patch.fx) * (1.0f - patch.fy)
+         + (patch.d01 * (1.0f - patch.fx) + patch.d11 * patch.fx) * patch.fy;
+}
+
+Eigen::Vector2f ObstacleField::getNormal(const Eigen::Vector2f& point) const {
+    const Patch patch{getPatch(point)};
+    const Eigen::Vector2f gradient{(patch.d10 - patch.d00) * (1.0f - patch.fy) + (patch.d11 - patch.d01) * patch.fy,
+                                   (patch.d01 - patch.d00) * (1.0f - patch.fx) + (patch.d11 - patch.d10) * patch.fx};
+    const float norm{gradient.norm()};
+
+    if (norm < 1.0e-6f) {
+        return Eigen::Vector2f::Zero();
+    }
+
+    return gradient / norm;
+}
+
+float ObstacleField::timeOfImpact(const Eigen::Vector2f& start, const Eigen::Vector2f& displacement, float radius) const {
+    const float length{displacement.norm()};
+
+    if (!m_hasObstacles || length == 0.0f) {
+        return -1.0f;
+    }
+
+    if (getDistance(start) < radius) {
+        return getNormal(start).dot(displacement) < 0.0f ? 0.0f : -1.0f;
+    }
+
+    // The bilinear field can change by up to sqrt(2) px per px of travel
+    const float minStep{minTraceStep * m_spacing};
+    float travelled{0.0f};
+
+    while (travelled <= length) {
+        const float clearance{getDistance(start + displacement * (travelled / length)) - radius};
+
+        if (clearance <= 0.0f) {
+            return travelled / length;
+        }
+
+        travelled += std::max(clearance / std::sqrt(2.0f), minStep);
+    }
+
+    // The end of the move may still be closer than a step
+    return getDistance(start + displacement) < radius ? 1.0f : -1.0f;
+}
+
+ObstacleField::Patch ObstacleField::getPatch(const Eigen::Vector2f& point) const {
+    // Samples sit at the centers of their little squares
+    const float u{point(0) / m_spacing - 0.5f};
+    const float v{point(1) / m_spacing - 0.5f};
+    const int i{std::clamp(static_cast<int>(std::floor(u)), 0, m_width - 2)};
+    const int j{std::clamp(static_cast<int>(std::floor(v)), 0, m_height - 2)};
+    const std::size_t index{static_cast<std::size_t>(j) * m_width + i};
+
+    return Patch{m_distances[index], m_distances[index + 1], m_distances[index + m_width], m_distances[index + m_width + 1],
+                 std::clamp(u - i, 0.0f, 1.0f), std::clamp(v - j, 0.0f, 1.0f)};
+}
+
+void ObstacleField::transformLine(std::size_t line) {
+    const bool column{line < static_cast<std::size_t>(m_buildWidth)};
+    const std::size_t length{static_cast<std::size_t>(column ? m_buildHeight : m_buildWidth)};
+    const std::size_t start{column ? line : (line - m_buildWidth) * m_buildWidth};
+    const std::size_t stride{column ? static_cast<std::size_t>(m_buildWidth) : 1};
+
+    for (std::vector<float>* distances : {&m_distancesToSolid, &m_distancesToFree}) {
+        for (std::size_t q = 0; q < length; ++q) {
+            m_line[q] = (*distances)[start + q * stride];
+        }
+
+        // Lower envelope of the parabolas rooted at each sample
+        auto intersection = [this](int q, int p) {
+            return ((static_cast<double>(m_line[q]) + static_cast<double>(q) * q) - (static_cast<double>(m_line[p]) + static_cast<double>(p) * p))
+                   / (2.0 * q - 2.0 * p);
+        };
+
+        int k{0};
+        m_parabolas[0] = 0;
+        m_boundaries[0] = -infinity;
+        m_boundaries[1] = infinity;
+
+        for (int q = 1; q < static_cast<int>(length); ++q) {
+            double boundary{intersection(q, m_parabolas[k])};
+
+            while (boundary <= m_boundaries[k]) {
+                --k;
+                boundary = intersection(q, m_parabolas[k]);
+            }
+
+            ++k;
+            m_parabolas[k] = q;
+            m_boundaries[k] = static_cast<float>(boundary);
+            m_boundaries[k + 1] = infinity;
+        }
+
+        k = 0;
+
+        for (int q = 0; q < static_cast<int>(length); ++q) {
+            while (m_boundaries[k + 1] < q) {
+                ++k;
+            }
+
+            const float offset{static_cast<float>(q - m_parabolas[k])};
+            m_lineResult[q] = offset * offset + m_line[m_parabolas[k]];
+        }
+
+        for (std::size_t q = 0; q < length; ++q) {
+            (*distances)[start + q * stride] = m_lineResult[q];
+        }
+    }
+}
+
+void ObstacleField::finishBuild() {
+    m_building = false;
+    m_hasObstacles = m_buildHasObstacles;
+    m_width = m_buildWidth;
+    m_height = m_buildHeight;
+    m_spacing = m_buildSpacing;
+
+    if (!m_hasObstacles) {
+        m_distances.clear();
+        return;
+    }
+
+    // Half a sample between the centers of a solid and a free sample puts the surface on the border
+    m_distances.resize(m_distancesToSolid.size());
+
+    for (std::size_t i = 0; i < m_distances.size(); ++i) {
+        m_distances[i] = m_distancesToFree[i] == 0.0f ? (std::sqrt(m_distancesToSolid[i]) - 0.5f) * m_spacing
+                                                      : -(std::sqrt(m_distancesToFree[i]) - 0.5f) * m_spacing;
+    }
+}
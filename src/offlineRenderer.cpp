@@ -0,0 +1,272 @@
+#include <SDL3/SDL.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "offlineRenderer.h"
+#include "map.h"
+#include "particle.h"
+#include "threadPool.h"
+
+OfflineRenderer::OfflineRenderer(int width, int height, ThreadPool& threadPool) : m_width(width),
+                                                                                   m_height(height),
+                                                                                   m_threadPool(threadPool),
+                                                                                   m_nbTilesX((width + m_tileSize - 1) / m_tileSize),
+                                                                                   m_nbTilesY((height + m_tileSize - 1) / m_tileSize) {}
+
+void OfflineRenderer::render(const std::vector<Particle>& particles, const Map& map, const SDL_FRect camera) {
+    const std::size_t framebufferSize{static_cast<std::size_t>(m_width) * m_height * 4};
+
+    if (m_framebuffer.size() != framebufferSize) {
+        m_framebuffer.resize(framebufferSize);
+    }
+
+    if (m_tileBuffers.size() != m_threadPool.getNbThreads()) {
+        m_tileBuffers.assign(m_threadPool.getNbThreads(), std::vector<float>(m_tileSize * m_tileSize * 4));
+    }
+
+    binParticles(particles, camera);
+
+    m_threadPool.parallelFor(static_cast<std::size_t>(m_nbTilesX * m_nbTilesY), [&](std::size_t begin, std::size_t end, unsigned threadIndex) {
+        for (std::size_t tile = begin; tile < end; ++tile) {
+            rasterizeTile(static_cast<int>(tile), threadIndex, map, camera);
+        }
+    });
+}
+
+void OfflineRenderer::binParticles(const std::vector<Particle>& particles, const SDL_FRect camera) {
+    const std::size_t nbParticles{particles.size()};
+    const unsigned nbThreads{m_threadPool.getNbThreads()};
+    const int nbTiles{m_nbTilesX * m_nbTilesY};
+    const float scale{static_cast<float>(m_width) / camera.w};
+
+    m_discs.resize(nbParticles);
+    m_threadTileCounts.assign(static_cast<std::size_t>(nbThreads) * nbTiles, 0);
+
+    // Tiles touched by a disc, one extra pixel for the anti-aliased edge
+    auto tileRange = [this](const Disc& disc, int& minTileX, int& maxTileX, int& minTileY, int& maxTileY) -> bool {
+        const float extent{disc.radius + 1.0f};
+
+        if (disc.x + extent < 0.0f || disc.x - extent > m_width || disc.y + extent < 0.0f || disc.y - extent > m_height) {
+            return false;
+        }
+
+        minTileX = std::max(0, static_cast<int>((disc.x - extent) / m_tileSize));
+        maxTileX = std::min(m_nbTilesX - 1, static_cast<int>((disc.x + extent) / m_tileSize));
+        minTileY = std::max(0, static_cast<int>((disc.y - extent) / m_tileSize));
+        maxTileY = std::min(m_nbTilesY - 1, static_cast<int>((disc.y + extent) / m_tileSize));
+
+        return true;
+    };
+
+    // First pass: screen-space discs and per-thread tile counts
+    m_threadPool.parallelFor(nbParticles, [&](std::size_t begin, std::size_t end, unsigned threadIndex) {
+        std::uint32_t* counts{&m_threadTileCounts[static_cast<std::size_t>(threadIndex) * nbTiles]};
+        int minTileX, maxTileX, minTileY, maxTileY;
+
+        for (std::size_t i = begin; i < end; ++i) {
+            const SDL_FRect rect{particles[i].getParticle()};
+            const float radius{rect.w / 2.0f};
+
+            Disc& disc{m_discs[i]};
+            disc.x = (rect.x + radius - camera.x) * scale;
+            disc.y = (rect.y + radius - camera.y) * scale;
+            disc.radius = radius * scale;
+
+            if (!tileRange(disc, minTileX, maxTileX, minTileY, maxTileY)) {
+                continue;
+            }
+
+            for (int tileY = minTileY; tileY <= maxTileY; ++tileY) {
+                for (int tileX = minTileX; tileX <= maxTileX; ++tileX) {
+                    ++counts[tileY * m_nbTilesX + tileX];
+                }
+            }
+        }
+    });
+
+    // Prefix sum in (tile, thread) order, counts become the write cursor of each thread in each tile.
+    // Thread k always gets the k-th chunk of particles so the particle order is kept inside a tile.
+    m_tileOffsets.resize(nbTiles + 1);
+    std::uint32_t offset{0};
+
+    for (int tile = 0; tile < nbTiles; ++tile) {
+        m_tileOffsets[tile] = offset;
+
+        for (unsigned thread = 0; thread < nbThreads; ++thread) {
+            std::uint32_t& count{m_threadTileCounts[static_cast<std::size_t>(thread) * nbTiles + tile]};
+            const std::uint32_t threadCount{count};
+            count = offset;
+            offset += threadCount;
+        }
+    }
+    m_tileOffsets[nbTiles] = offset;
+
+    m_tileParticles.resize(offset);
+
+    // Second pass: scatter the particle indices into their tiles
+    m_threadPool.parallelFor(nbParticles, [&](std::size_t begin, std::size_t end, unsigned threadIndex) {
+        std::uint32_t* cursors{&m_threadTileCounts[static_cast<std::size_t>(threadIndex) * nbTiles]};
+        int minTileX, maxTileX, minTileY, maxTileY;
+
+        for (std::size_t i = begin; i < end; ++i) {
+            if (!tileRange(m_discs[i], minTileX, maxTileX, minTileY, maxTileY)) {
+                continue;
+            }
+
+            for (int tileY = minTileY; tileY <= maxTileY; ++tileY) {
+                for (int tileX = minTileX; tileX <= maxTileX; ++tileX) {
+                    m_tileParticles[cursors[tileY * m_nbTilesX + tileX]++] = static_cast<std::uint32_t>(i);
+                }
+            }
+        }
+    });
+}
+
+void OfflineRenderer::rasterizeTile(int tile, unsigned threadIndex, const Map& map, const SDL_FRect camera) {
+    const int tileX{tile % m_nbTilesX};
+    const int tileY{tile / m_nbTilesX};
+
+    const int minX{tileX * m_tileSize};
+    const int minY{tileY * m_tileSize};
+    const int maxX{std::min(minX + m_tileSize, m_width)};
+    const int maxY{std::min(minY + m_tileSize, m_height)};
+    const int tileWidth{maxX - minX};
+
+    const float scale{static_cast<float>(m_width) / camera.w};
+    float* buffer{m_tileBuffers[threadIndex].data()};
+
+    // Background
+    for (int y = minY; y < maxY; ++y) {
+        for (int x = minX; x < maxX; ++x) {
+            float* pixel{&buffer[((y - minY) * tileWidth + (x - minX)) * 4]};
+
+            if (m_style == Style::densitySplats) {
+                pixel[0] = 0.0f;
+                continue;
+            }
+
+            // Same chessboard and obstacles as Map::setTexture, black outside of the map
+            const float worldX{camera.x + (x + 0.5f) / scale};
+            const float worldY{camera.y + (y + 0.5f) / scale};
+            float red{0.0f}, green{0.0f}, blue{0.0f};
+
+            if (worldX >= 0.0f && worldY >= 0.0f && worldX < map.getWidth() && worldY < map.getHeight()) {
+                const int col{static_cast<int>(worldX / map.getSquareSize())};
+                const int row{static_cast<int>(worldY / map.getSquareSize())};
+
+                if (map.isSolid(col, row)) {
+                    red = 140.0f / 255.0f;
+                    green = 60.0f / 255.0f;
+                    blue = 30.0f / 255.0f;
+                } else {
+                    red = ((col + row) % 2 == 0 ? 50.0f : 150.0f) / 255.0f;
+                    green = red;
+                    blue = red;
+                }
+            }
+
+            pixel[0] = red;
+            pixel[1] = green;
+            pixel[2] = blue;
+            pixel[3] = 1.0f;
+        }
+    }
+
+    // Same colour as the shared particle texture
+    constexpr float particleRed{0.0f}, particleGreen{0.0f}, particleBlue{1.0f}, particleAlpha{200.0f / 255.0f};
+
+    for (std::uint32_t k = m_tileOffsets[tile]; k < m_tileOffsets[tile + 1]; ++k) {
+        const Disc& disc{m_discs[m_tileParticles[k]]};
+
+        // Sub-pixel discs are drawn as half pixel discs with a fainter intensity to keep their contribution
+        const float radius{std::max(disc.radius, 0.5f)};
+        const float intensity{disc.radius < 0.5f ? (disc.radius * disc.radius) / 0.25f : 1.0f};
+
+        const int discMinX{std::max(minX, static_cast<int>(std::floor(disc.x - radius - 0.5f)))};
+        const int discMaxX{std::min(maxX - 1, static_cast<int>(std::ceil(disc.x + radius + 0.5f)))};
+        const int discMinY{std::max(minY, static_cast<int>(std::floor(disc.y - radius - 0.5f)))};
+        const int discMaxY{std::min(maxY - 1, static_cast<int>(std::ceil(disc.y + radius + 0.5f)))};
+
+        // Only the pixels on the edge need a square root, inside ones are fully covered
+        const float innerSquared{radius > 0.5f ? (radius - 0.5f) * (radius - 0.5f) : -1.0f};
+        const float outerSquared{(radius + 0.5f) * (radius + 0.5f)};
+
+        for (int y = discMinY; y <= discMaxY; ++y) {
+            const float dy{y + 0.5f - disc.y};
+
+            for (int x = discMinX; x <= discMaxX; ++x) {
+                const float dx{x + 0.5f - disc.x};
+                const float distanceSquared{dx * dx + dy * dy};
+
+                if (distanceSquared >= outerSquared) {
+                    continue;
+                }
+
+                // Coverage of the pixel approximated by its distance to the edge
+                float coverage{intensity};
+                if (distanceSquared > innerSquared) {
+                    coverage *= std::clamp(radius - std::sqrt(distanceSquared) + 0.5f, 0.0f, 1.0f);
+                }
+
+                float* pixel{&buffer[((y - minY) * tileWidth + (x - minX)) * 4]};
+
+                if (m_style == Style::densitySplats) {
+                    pixel[0] += coverage;
+                    continue;
+                }
+
+                const float alpha{particleAlpha * coverage};
+                pixel[0] += (particleRed - pixel[0]) * alpha;
+                pixel[1] += (particleGreen - pixel[1]) * alpha;
+                pixel[2] += (particleBlue - pixel[2]) * alpha;
+                pixel[3] += (1.0f - pixel[3]) * alpha;
+            }
+        }
+    }
+
+    // Resolve into the framebuffer
+    constexpr float exposure{0.35f};
+
+    for (int y = minY; y < maxY; ++y) {
+        for (int x = minX; x < maxX; ++x) {
+            const float* pixel{&buffer[((y - minY) * tileWidth + (x - minX)) * 4]};
+            std::uint8_t* output{&m_framebuffer[(static_cast<std::size_t>(y) * m_width + x) * 4]};
+
+            float red{pixel[0]}, green{pixel[1]}, blue{pixel[2]}, alpha{pixel[3]};
+
+            if (m_style == Style::densitySplats) {
+                // Overlapping splats saturate smoothly instead of clipping
+                const float value{1.0f - std::exp(-pixel[0] * exposure)};
+                red = value * value;
+                green = value;
+                blue = std::sqrt(value);
+                alpha = 1.0f;
+            }
+
+            output[0] = static_cast<std::uint8_t>(std::clamp(red, 0.0f, 1.0f) * 255.0f + 0.5f);
+            output[1] = static_cast<std::uint8_t>(std::clamp(green, 0.0f, 1.0f) * 255.0f + 0.5f);
+            output[2] = static_cast<std::uint8_t>(std::clamp(blue, 0.0f, 1.0f) * 255.0f + 0.5f);
+            output[3] = static_cast<std::uint8_t>(std::clamp(alpha, 0.0f, 1.0f) * 255.0f + 0.5f);
+        }
+    }
+}
+
+void OfflineRenderer::encodePPM(std::vector<std::uint8_t>& bytes) const {
+    char header[32];
+    const int headerSize{std::snprintf(header, sizeof(header), "P6\n%d %d\n255\n", m_width, m_height)};
+
+    bytes.resize(static_cast<std::size_t>(headerSize) + static_cast<std::size_t>(m_width) * m_height * 3);
+    std::copy(header, header + headerSize, bytes.begin());
+
+    // PPM has no alpha channel
+    std::uint8_t* output{bytes.data() + headerSize};
+    const std::size_t nbPixels{static_cast<std::size_t>(m_width) * m_height};
+
+    for (std::size_t i = 0; i < nbPixels; ++i) {
+        output[i * 3 + 0] = m_framebuffer[i * 4 + 0];
+        output[i * 3 + 1] = m_framebuffer[i * 4 + 1];
+        output[i * 3 + 2] = m_framebuffer[i * 4 + 2];
+    }
+}
@@ -1,12 +1,15 @@
 #include <SDL3/SDL.h>
 #include <algorithm>
 #include <cmath>
+#include <memory_resource>
 #include <stdexcept>
+#include <vector>
 #include "Eigen/Dense"
 
 #include "particle.h"
 #include "particleErrors.h"
 #include "map.h"
+#include "obstacleField.h"
 
 void Particle::setSharedTexture(SDL_Renderer* renderer) {
     SDL_Surface* surface{setSharedSurface()};
@@ -66,7 +69,7 @@ Particle::Particle(const int mass, const Eigen::Vector2f velocity) : m_mass(mass
         throw std::invalid_argument("Mass cannot be less than 1 kg nor negative");
     }
 
-    float particleDiameter = static_cast<float>(sharedParticleDiameter) * std::sqrt(static_cast<float>(m_mass) / static_cast<float>(sharedParticleMass));
+    float particleDiameter = getDiameter(m_mass);
 
     if (particleDiameter < 5.0f) {
         throw std::domain_error("The ParticleDiameter that has been computed is too small to be displayed on screen");
@@ -80,8 +83,29 @@ void Particle::setCoordinates(const Map &map, float x, float y) {
     m_particle.x = x;
     m_particle.y = y;
 
-    m_particle.x = std::clamp(m_particle.x, 0.0f, map.getWidth() - m_particle.w);
-    m_particle.y = std::clamp(m_particle.y, 0.0f, map.getHeight() - m_particle.h);
+    if (map.isUnbounded()) {
+        return;
+    }
+
+    // A particle larger than the map (merged ones can grow) sticks to the top left corner
+    m_particle.x = std::clamp(m_particle.x, 0.0f, std::max(0.0f, map.getWidth() - m_particle.w));
+    m_particle.y = std::clamp(m_particle.y, 0.0f, std::max(0.0f, map.getHeight() - m_particle.h));
+}
+
+void Particle::merge(const Particle& otherParticle, const Map& map) {
+    const float mass{static_cast<float>(m_mass)};
+    const float otherMass{static_cast<float>(otherParticle.m_mass)};
+    const float totalMass{mass + otherMass};
+
+    const Eigen::Vector2f centerOfMass{(mass * getCenter() + otherMass * otherParticle.getCenter()) / totalMass};
+
+    m_velocity = (mass * m_velocity + otherMass * otherParticle.m_velocity) / totalMass;
+    m_mass += otherParticle.m_mass;
+
+    m_particle.w = getDiameter(m_mass);
+    m_particle.h = m_particle.w;
+
+    setCoordinates(map, centerOfMass(0) - m_particle.w / 2.0f, centerOfMass(1) - m_particle.h / 2.0f);
 }
 
 void Particle::move(const float deltaTime) {
@@ -92,6 +116,10 @@ void Particle::move(const float deltaTime) {
 }
 
 void Particle::solveWallCollision(const Map& map) {
+    if (map.isUnbounded()) {
+        return;
+    }
+
     const float maxX = map.getWidth() - m_particle.w;
     const float maxY = map.getHeight() - m_particle.h;
 
@@ -114,6 +142,63 @@ void Particle::solveWallCollision(const Map& map) {
     }
 }
 
+void Particle::solveObstacleCollision(const ObstacleField& obstacles, float restitution) {
+    const Eigen::Vector2f center{getCenter()};
+    const float radius{m_particle.w / 2.0f};
+    const float distance{obstacles.getDistance(center)};
+
+    if (distance >= radius) {
+        return;
+    }
+
+    const Eigen::Vector2f normal{obstacles.getNormal(center)};
+
+    if (normal.isZero()) {
+        return;
+    }
+
+    m_particle.x += (radius - distance) * normal(0);
+    m_particle.y += (radius - distance) * normal(1);
+
+    // Only reflect if moving into the obstacle
+    const float normalSpeed{m_velocity.dot(normal)};
+
+    if (normalSpeed < 0.0f) {
+        m_velocity -= (1.0f + restitution) * normalSpeed * normal;
+    }
+}
+
+void Particle::moveAgainstObstacles(const ObstacleField& obstacles, float deltaTime, float restitution) {
+    const float radius{m_particle.w / 2.0f};
+    float remainingTime{deltaTime};
+
+    for (int bounce = 0; remainingTime > 0.0f; ++bounce) {
+        const float fraction{obstacles.timeOfImpact(getCenter(), m_velocity * remainingTime, radius)};
+
+        if (fraction < 0.0f) {
+            move(remainingTime);
+            break;
+        }
+
+        move(fraction * remainingTime);
+        remainingTime -= fraction * remainingTime;
+
+        const Eigen::Vector2f normal{obstacles.getNormal(getCenter())};
+        const float normalSpeed{m_velocity.dot(normal)};
+
+        if (normalSpeed < 0.0f) {
+            m_velocity -= (1.0f + restitution) * normalSpeed * normal;
+        }
+
+        // Stuck in a corner, the particle waits at the contact for the next step
+        if (bounce + 1 == maxObstacleBounces) {
+            break;
+        }
+    }
+
+    solveObstacleCollision(obstacles, restitution);
+}
+
 bool Particle::checkCollisionInit(const Particle& otherParticle) {
     SDL_FRect otherParticleDescriptor{otherParticle.getParticle()};
 
@@ -136,7 +221,7 @@ bool Particle::checkCollisionInit(const Particle& otherParticle) {
     return false;
 }
 
-void Particle::checkSolveCollision(Particle& otherParticle) {
+void Particle::checkSolveCollision(Particle& otherParticle, float restitution) {
     SDL_FRect otherParticleDescriptor{otherParticle.getParticle()};
 
     const float particleRadius{m_particle.w / 2.0f};
@@ -152,10 +237,14 @@ void Particle::checkSolveCollision(Particle& otherParticle) {
     const float expectedCenterDistance{particleRadius + otherParticleRadius};
     
     if (actualCenterDistance <= expectedCenterDistance) {
-        Eigen::Vector2f normalUnitVector{deltaPos(0) / actualCenterDistance,
-                                         deltaPos(1) / actualCenterDistance};
+        // Coincident centers (dense generated populations, clamped corners) are pushed apart along x
+        Eigen::Vector2f normalUnitVector{1.0f, 0.0f};
 
-        solveCollision(otherParticle, normalUnitVector);
+        if (actualCenterDistance > 0.0f) {
+            normalUnitVector = deltaPos / actualCenterDistance;
+        }
+
+        solveCollision(otherParticle, normalUnitVector, restitution);
 
         // Solves the overlapping/jiggling issue
         const float overlap = expectedCenterDistance - actualCenterDistance;
@@ -168,9 +257,21 @@ void Particle::checkSolveCollision(Particle& otherParticle) {
     }
 }
 
-void Particle::solveCollision(Particle& otherParticle, const Eigen::Vector2f& normalUnitVector) {
+void Particle::solveContactCollision(Particle& otherParticle, float restitution) {
+    const Eigen::Vector2f deltaPos{otherParticle.getCenter() - getCenter()};
+    const float distance{deltaPos.norm()};
+
+    if (distance == 0.0f) {
+        return;
+    }
+
+    solveCollision(otherParticle, deltaPos / distance, restitution);
+}
+
+void Particle::solveCollision(Particle& otherParticle, const Eigen::Vector2f& normalUnitVector, float restitution) {
     // The main idea is that we are solving the system of equation along the normal plane of the impact
-    // the collisation is perfectly elastic, the system of equation can be found online
+    // momentum is conserved and the normal relative velocity is multiplied by -restitution
+    // (perfectly elastic for 1), the system of equation can be found online
     const Eigen::Vector2f tangentUnitVector{-normalUnitVector(1),
                                             normalUnitVector(0)};
 
@@ -182,12 +283,12 @@ void Particle::solveCollision(Particle& otherParticle, const Eigen::Vector2f& no
     const float sumMass{static_cast<float>(m_mass + otherParticle.m_mass)};
 
     // particle coefficients
-    const float firstCoeff{(m_mass - otherParticle.m_mass) / sumMass};
-    const float secondCoeff{(2 * otherParticle.m_mass) / sumMass};
+    const float firstCoeff{(m_mass - restitution * otherParticle.m_mass) / sumMass};
+    const float secondCoeff{((1.0f + restitution) * otherParticle.m_mass) / sumMass};
 
     // other particle coefficients
-    const float thirdCoeff{(2 * m_mass) / sumMass};
-    const float fourthCoeff{-firstCoeff};
+    const float thirdCoeff{((1.0f + restitution) * m_mass) / sumMass};
+    const float fourthCoeff{(otherParticle.m_mass - restitution * m_mass) / sumMass};
 
     Eigen::Vector2f newNormalVelocities{firstCoeff * particleVelocityNT(0) + secondCoeff * otherParticleVelocityNT(0),
                                         thirdCoeff * particleVelocityNT(0) + fourthCoeff * otherParticleVelocityNT(0)};
@@ -204,20 +305,101 @@ void Particle::solveCollision(Particle& otherParticle, const Eigen::Vector2f& no
     otherParticle.m_velocity = otherParticleFinalVelocityXY;
 }
 
-void Particle::render(SDL_Renderer* renderer, const SDL_FRect simulationViewport, const float screenWidth) {
+float Particle::getInteractionRangeFactor(PairInteraction interaction) {
+    // Lennard-Jones sigma is chosen so that the minimum is at contact, truncated at 2.5 sigma
+    static const float lennardJonesRange{2.5f / std::pow(2.0f, 1.0f / 6.0f)};
+
+    switch (interaction) {
+        case PairInteraction::lennardJones:
+            return lennardJonesRange;
+        default:
+            return 1.0f;
+    }
+}
+
+float Particle::applyPairForce(Particle& otherParticle, PairInteraction interaction, float strength, float deltaTime) {
+    if (interaction == PairInteraction::hardSphere || interaction == PairInteraction::merging) {
+        return 0.0f;
+    }
+
+    const Eigen::Vector2f deltaPos{otherParticle.getCenter() - getCenter()};
+    const float contactDistance{(m_particle.w + otherParticle.m_particle.w) / 2.0f};
+    const float range{contactDistance * getInteractionRangeFactor(interaction)};
+
+    const float distanceSquared{deltaPos.dot(deltaPos)};
+
+    // Coincident centers have no direction to push along
+    if (distanceSquared >= range * range || distanceSquared == 0.0f) {
+        return 0.0f;
+    }
+
+    const float distance{std::sqrt(distanceSquared)};
+    const Eigen::Vector2f normalUnitVector{deltaPos / distance};
+
+    // Positive force pushes the particles apart
+    float force{0.0f};
+    float potential{0.0f};
+
+    if (interaction == PairInteraction::softRepulsion) {
+        const float overlap{contactDistance - distance};
+        force = strength * overlap;
+        potential = 0.5f * strength * overlap * overlap;
+    }
+    else {
+        const float sigma{contactDistance / std::pow(2.0f, 1.0f / 6.0f)};
+        auto lennardJones = [strength, sigma](float r) -> float {
+            const float sixth{std::pow(sigma / r, 6.0f)};
+            return 4.0f * strength * (sixth * sixth - sixth);
+        };
+
+        // Deep overlaps (spawn, large steps) would give an almost infinite kick, so the force is capped there
+        const float clampedDistance{std::max(distance, 0.8f * sigma)};
+        const float sixth{std::pow(sigma / clampedDistance, 6.0f)};
+        force = 24.0f * strength * (2.0f * sixth * sixth - sixth) / clampedDistance;
+
+        // Shifted so that the potential is continuous at the cutoff
+        potential = lennardJones(clampedDistance) - lennardJones(range);
+    }
+
+    const Eigen::Vector2f impulse{force * deltaTime * normalUnitVector};
+
+    m_velocity -= impulse / static_cast<float>(m_mass);
+    otherParticle.m_velocity += impulse / static_cast<float>(otherParticle.m_mass);
+
+    return potential;
+}
+
+bool Particle::appendDisc(std::pmr::vector<SDL_Vertex>& vertices, const SDL_FRect& disc, const SDL_FRect simulationViewport, const float screenWidth) {
     float scale {screenWidth / simulationViewport.w};
 
-    m_viewport.x = (m_particle.x - simulationViewport.x) * scale;
-    m_viewport.y = (m_particle.y - simulationViewport.y) * scale;
-    m_viewport.w = m_particle.w * scale;
-    m_viewport.h = m_particle.h * scale;
+    bool conditionX{disc.x + disc.w < simulationViewport.x || disc.x > simulationViewport.x + simulationViewport.w};
+    bool conditionY{disc.y + disc.h < simulationViewport.y || disc.y > simulationViewport.y + simulationViewport.h};
 
-    bool conditionX{m_particle.x + m_particle.w < simulationViewport.x || m_particle.x > simulationViewport.x + simulationViewport.w};
-    bool conditionY{m_particle.y + m_particle.h < simulationViewport.y || m_particle.y > simulationViewport.y + simulationViewport.h};
+    if (conditionX || conditionY) {
+        return false;
+    }
 
-    if ((!conditionX) && (!conditionY)) {
-        if (!SDL_RenderTexture(renderer, m_texture, nullptr, &m_viewport)) {
-            throw ParticleError("Rendering the particle failed: ", SDL_GetError());
-        }
+    const float left{(disc.x - simulationViewport.x) * scale};
+    const float top{(disc.y - simulationViewport.y) * scale};
+    const float right{left + disc.w * scale};
+    const float bottom{top + disc.h * scale};
+    const SDL_FColor white{1.0f, 1.0f, 1.0f, 1.0f};
+
+    vertices.push_back(SDL_Vertex{SDL_FPoint{left, top}, white, SDL_FPoint{0.0f, 0.0f}});
+    vertices.push_back(SDL_Vertex{SDL_FPoint{right, top}, white, SDL_FPoint{1.0f, 0.0f}});
+    vertices.push_back(SDL_Vertex{SDL_FPoint{right, bottom}, white, SDL_FPoint{1.0f, 1.0f}});
+    vertices.push_back(SDL_Vertex{SDL_FPoint{left, bottom}, white, SDL_FPoint{0.0f, 1.0f}});
+    return true;
+}
+
+void Particle::renderDiscs(SDL_Renderer* renderer, const std::pmr::vector<SDL_Vertex>& vertices, const std::pmr::vector<int>& indices) {
+    if (vertices.empty()) {
+        return;
+    }
+
+    const int nbDiscs{static_cast<int>(vertices.size() / 4)};
+
+    if (!SDL_RenderGeometry(renderer, m_texture, vertices.data(), static_cast<int>(vertices.size()), indices.data(), 6 * nbDiscs)) {
+        throw ParticleError("Rendering the particles failed: ", SDL_GetError());
     }
 }
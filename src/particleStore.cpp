@@ -0,0 +1,125 @@
+#include <utility>
+#include <vector>
+#include "Eigen/Dense"
+
+#include "particleStore.h"
+#include "particleErrors.h"
+#include "particle.h"
+
+ParticleHandle ParticleStore::insert(int mass, const Eigen::Vector2f& velocity) {
+    m_particles.emplace_back(mass, velocity);
+
+    const std::uint32_t slot{acquireSlot(m_particles.size() - 1)};
+    m_slotOfIndex.push_back(slot);
+
+    return {slot, m_slots[slot].generation};
+}
+
+void ParticleStore::remove(ParticleHandle handle) {
+    if (!contains(handle)) {
+        throw ParticleError("Removing a particle that is not in the store anymore");
+    }
+
+    removeAt(m_slots[handle.slot].index);
+}
+
+void ParticleStore::removeAt(std::size_t index) {
+    const std::size_t last{m_particles.size() - 1};
+
+    releaseSlot(m_slotOfIndex[index]);
+
+    // Swap-to-end: the storage stays dense, only the moved particle changes index
+    if (index != last) {
+        m_particles[index] = std::move(m_particles[last]);
+        m_slotOfIndex[index] = m_slotOfIndex[last];
+        m_slots[m_slotOfIndex[index]].index = static_cast<std::uint32_t>(index);
+    }
+
+    m_particles.pop_back();
+    m_slotOfIndex.pop_back();
+}
+
+void ParticleStore::clear() {
+    while (!m_slotOfIndex.empty()) {
+        releaseSlot(m_slotOfIndex.back());
+        m_slotOfIndex.pop_back();
+    }
+
+    m_particles.clear();
+}
+
+void ParticleStore::replace(std::vector<Particle>& particles) {
+    clear();
+    m_particles.swap(particles);
+
+    for (std::size_t i = 0; i < m_particles.size(); ++i) {
+        m_slotOfIndex.push_back(acquireSlot(i));
+    }
+}
+
+void ParticleStore::replace(std::vector<Particle>& particles, const std::vector<ParticleHandle>& handles) {
+    clear();
+    m_particles.swap(particles);
+
+    for (std::size_t i = 0; i < m_particles.size(); ++i) {
+        const ParticleHandle handle{handles[i]};
+
+        if (handle.slot >= m_slots.size()) {
+            m_slots.resize(handle.slot + 1, Slot{ParticleHandle::invalidSlot, 0});
+        }
+
+        m_slots[handle.slot] = Slot{static_cast<std::uint32_t>(i), handle.generation};
+        m_slotOfIndex.push_back(handle.slot);
+    }
+
+    m_freeSlots.clear();
+
+    for (std::uint32_t slot = 0; slot < m_slots.size(); ++slot) {
+        if (m_slots[slot].index == ParticleHandle::invalidSlot) {
+            m_freeSlots.push_back(slot);
+        }
+    }
+}
+
+void ParticleStore::permute(const std::vector<std::uint32_t>& order) {
+    m_permutedParticles.clear();
+    m_permutedParticles.reserve(m_particles.size());
+    m_permutedSlots.resize(m_particles.size());
+
+    for (std::size_t k = 0; k < order.size(); ++k) {
+        m_permutedParticles.push_back(m_particles[order[k]]);
+        m_permutedSlots[k] = m_slotOfIndex[order[k]];
+        m_slots[m_permutedSlots[k]].index = static_cast<std::uint32_t>(k);
+    }
+
+    m_particles.swap(m_permutedParticles);
+    m_slotOfIndex.swap(m_permutedSlots);
+}
+
+void ParticleStore::reserve(std::size_t capacity) {
+    m_particles.reserve(capacity);
+    m_slotOfIndex.reserve(capacity);
+    m_slots.reserve(capacity);
+    m_freeSlots.reserve(capacity);
+}
+
+std::uint32_t ParticleStore::acquireSlot(std::size_t index) {
+    std::uint32_t slot;
+
+    if (m_freeSlots.empty()) {
+        slot = static_cast<std::uint32_t>(m_slots.size());
+        m_slots.push_back(Slot{0, 0});
+    } else {
+        slot = m_freeSlots.back();
+        m_freeSlots.pop_back();
+    }
+
+    m_slots[slot].index = static_cast<std::uint32_t>(index);
+    return slot;
+}
+
+void ParticleStore::releaseSlot(std::uint32_t slot) {
+    m_slots[slot].index = ParticleHandle::invalidSlot;
+    ++m_slots[slot].generation;
+    m_freeSlots.push_back(slot);
+}
@@ -0,0 +1,67 @@
+#include <cstdint>
+#include <vector>
+
+#include "remoteProtocol.h"
+#include "varint.h"
+
+void RemoteProtocol::encodeParticles(const std::vector<QuantizedParticle>& base, const std::vector<QuantizedParticle>& particles, std::vector<std::uint8_t>& bytes) {
+    std::size_t baseIndex{0};
+    std::uint64_t previousId{0};
+
+    for (const QuantizedParticle& particle : particles) {
+        Varint::append(bytes, particle.id - previousId);
+        previousId = particle.id;
+
+        // Both lists are sorted by id, the base is walked once
+        while (baseIndex < base.size() && base[baseIndex].id < particle.id) {
+            ++baseIndex;
+        }
+
+        if (baseIndex < base.size() && base[baseIndex].id == particle.id) {
+            const QuantizedParticle& previous{base[baseIndex]};
+            Varint::append(bytes, Varint::zigzag(particle.x - previous.x));
+            Varint::append(bytes, Varint::zigzag(particle.y - previous.y));
+            Varint::append(bytes, Varint::zigzag(particle.diameter - previous.diameter));
+        } else {
+            Varint::append(bytes, particle.x);
+            Varint::append(bytes, particle.y);
+            Varint::append(bytes, particle.diameter);
+        }
+    }
+}
+
+bool RemoteProtocol::decodeParticles(const std::uint8_t* data, std::size_t size, std::uint32_t nbParticles,
+                                     const std::vector<QuantizedParticle>& base, std::vector<QuantizedParticle>& particles) {
+    const std::uint8_t* end{data + size};
+
+    particles.clear();
+    particles.reserve(nbParticles);
+
+    std::size_t baseIndex{0};
+    std::uint64_t id{0};
+
+    for (std::uint32_t i = 0; i < nbParticles; ++i) {
+        std::uint64_t idDelta, x, y, diameter;
+
+        if (!Varint::read(data, end, idDelta) || !Varint::read(data, end, x) || !Varint::read(data, end, y) || !Varint::read(data, end, diameter)) {
+            return false;
+        }
+
+        id += idDelta;
+
+        while (baseIndex < base.size() && base[baseIndex].id < id) {
+            ++baseIndex;
+        }
+
+        if (baseIndex < base.size() && base[baseIndex].id == id) {
+            const QuantizedParticle& previous{base[baseIndex]};
+            x = static_cast<std::uint64_t>(previous.x + Varint::unzigzag(static_cast<std::uint32_t>(x)));
+            y = static_cast<std::uint64_t>(previous.y + Varint::unzigzag(static_cast<std::uint32_t>(y)));
+            diameter = static_cast<std::uint64_t>(previous.diameter + Varint::unzigzag(static_cast<std::uint32_t>(diameter)));
+        }
+
+        particles.push_back(QuantizedParticle{id, static_cast<std::uint16_t>(x), static_cast<std::uint16_t>(y), static_cast<std::uint16_t>(diameter)});
+    }
+
+    return data == end;
+}
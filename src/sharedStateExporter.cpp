@@ -0,0 +1,119 @@
+#include <atomic>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <new>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "sharedStateExporter.h"
+#include "sharedStateErrors.h"
+#include "sharedState.h"
+#include "particle.h"
+
+void SharedStateExporter::open(const char* name, std::uint32_t capacity) {
+    close();
+
+    const std::size_t size{SharedState::segmentSize(capacity)};
+
+    int fd{shm_open(name, O_CREAT | O_RDWR, 0644)};
+
+    if (fd == -1) {
+        throw SharedStateError("Opening the shared memory segment failed: ", std::strerror(errno));
+    }
+
+    if (ftruncate(fd, static_cast<off_t>(size)) == -1) {
+        const int error{errno};
+        ::close(fd);
+        shm_unlink(name);
+        throw SharedStateError("Resizing the shared memory segment failed: ", std::strerror(error));
+    }
+
+    void* address{mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)};
+
+    // The mapping keeps the segment alive, we don't need the descriptor anymore
+    ::close(fd);
+
+    if (address == MAP_FAILED) {
+        shm_unlink(name);
+        throw SharedStateError("Mapping the shared memory segment failed: ", std::strerror(errno));
+    }
+
+    m_name = name;
+    m_size = size;
+    m_header = new (address) SharedState::Header{};
+
+    m_header->capacity = capacity;
+    m_header->headerSize = static_cast<std::uint32_t>(SharedState::headerSize());
+    m_header->layoutVersion = SharedState::layoutVersion;
+
+    // Readers check the magic last, so everything else has to be visible before it
+    std::atomic_thread_fence(std::memory_order_release);
+    m_header->magic = SharedState::magic;
+}
+
+void SharedStateExporter::close() {
+    if (!m_header) {
+        return;
+    }
+
+    // Readers still mapping this segment learn that it won't be updated anymore
+    m_header->retired.store(1, std::memory_order_release);
+
+    munmap(m_header, m_size);
+    shm_unlink(m_name.c_str());
+
+    m_header = nullptr;
+    m_size = 0;
+}
+
+void SharedStateExporter::publish(const std::vector<Particle>& particles, std::uint64_t step) {
+    if (!m_header) {
+        return;
+    }
+
+    // Grow by half at least, so that a growing population doesn't recreate the segment every step
+    if (particles.size() > m_header->capacity) {
+        const std::size_t capacity{std::max<std::size_t>(particles.size(), m_header->capacity + m_header->capacity / 2)};
+
+        if (capacity > std::numeric_limits<std::uint32_t>::max()) {
+            throw SharedStateError("Too many particles for a shared memory segment");
+        }
+
+        const std::string name{m_name};
+        open(name.c_str(), static_cast<std::uint32_t>(capacity));
+    }
+
+    const std::uint32_t nbParticles{static_cast<std::uint32_t>(particles.size())};
+
+    float* centerX{SharedState::array(m_header, SharedState::centerX)};
+    float* centerY{SharedState::array(m_header, SharedState::centerY)};
+    float* velocityX{SharedState::array(m_header, SharedState::velocityX)};
+    float* velocityY{SharedState::array(m_header, SharedState::velocityY)};
+    float* diameter{SharedState::array(m_header, SharedState::diameter)};
+
+    // Seqlock write: odd sequence while writing, readers retry if it changed during their copy
+    const std::uint64_t sequence{m_header->sequence.load(std::memory_order_relaxed)};
+    m_header->sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    for (std::uint32_t i = 0; i < nbParticles; ++i) {
+        const SDL_FRect rect{particles[i].getParticle()};
+        const Eigen::Vector2f velocity{particles[i].getVelocity()};
+
+        centerX[i] = rect.x + rect.w / 2.0f;
+        centerY[i] = rect.y + rect.h / 2.0f;
+        velocityX[i] = velocity(0);
+        velocityY[i] = velocity(1);
+        diameter[i] = rect.w;
+    }
+
+    m_header->nbParticles.store(nbParticles, std::memory_order_relaxed);
+    m_header->step.store(step, std::memory_order_relaxed);
+
+    m_header->sequence.store(sequence + 2, std::memory_order_release);
+}
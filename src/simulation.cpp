@@ -1,18 +1,36 @@
 #include <SDL3/SDL.h>
+#include <algorithm>
 #include <vector>
 #include <random>
 #include <cmath>
+#include <cstdio>
+#include <cfloat>
+#include <cstdlib>
+#include <string>
+#include <filesystem>
+#include <utility>
+#include <memory_resource>
 #include "imgui.h"
 #include "imgui_impl_sdl3.h"
 #include "imgui_impl_sdlrenderer3.h"
 
 #include "simulation.h"
 #include "simulationErrors.h"
+#include "mapErrors.h"
+#include "checkpointErrors.h"
 #include "map.h"
 #include "viewport.h"
 #include "particle.h"
-
-Simulation::Simulation(const char* appName, const char* creatorName) : m_map(300, 300, 50), m_viewport() {
+#include "sharedState.h"
+#include "checkpoint.h"
+#include "philox.h"
+#include "allocationTracker.h"
+
+Simulation::Simulation(const char* appName, const char* creatorName) : m_map(300, 300, 50),
+                                                                      m_viewport(),
+                                                                      m_mortonOrder(m_threadPool),
+                                                                      m_fastMultipole(m_threadPool),
+                                                                      m_initialConditions(m_threadPool) {
     if (!SDL_SetAppMetadata(appName, nullptr, nullptr)) {
         throw SimulationError("Setting up the app metadata failed: ", SDL_GetError());
     }
@@ -36,13 +54,24 @@ Simulation::Simulation(const char* appName, const char* creatorName) : m_map(300
     m_map.setTexture(m_renderer);
     Particle::setSharedTexture(m_renderer);
 
+    // Front end tools, a headless Simulation only builds the ones its settings ask for
+    m_sharedStateExporter.emplace();
+    m_fileWriter.emplace();
+    m_frameRecorder.emplace(recordingWidth, recordingHeight, m_map, 0, *m_fileWriter, defaultFramesDirectory);
+
     m_viewport.setSize(m_map, screenWidth, screenHeight);
 
+    // A new seed per launch, shown in the ImGui window to reproduce the run
+    std::random_device randomDevice;
+    m_seed = (static_cast<std::uint64_t>(randomDevice()) << 32) | randomDevice();
+    m_initialConditionSettings.seed = m_seed;
+
     m_particles.reserve(maxNBParticlesSim);
     spawnDestroyParticles(nbParticlesWantedSim);
 
     // Setup Dear ImGui context
     IMGUI_CHECKVERSION();
+    AllocationTracker::installImGuiAllocator();
     ImGui::CreateContext();
     ImGui::StyleColorsDark();
 
@@ -51,6 +80,81 @@ Simulation::Simulation(const char* appName, const char* creatorName) : m_map(300
     ImGui_ImplSDLRenderer3_Init(m_renderer);
 }
 
+Simulation::Simulation(const SimulationSettings& settings) : m_headless(true),
+                                                            m_map(300, 300, 50),
+                                                            m_viewport(),
+                                                            m_threadPool(settings.nbThreads),
+                                                            m_mortonOrder(m_threadPool),
+                                                            m_fastMultipole(m_threadPool),
+                                                            m_seed(settings.seed),
+                                                            m_minMass(settings.minMass),
+                                                            m_maxMass(settings.maxMass),
+                                                            m_maxSpeed(settings.maxSpeed),
+                                                            m_restitution(settings.restitution),
+                                                            m_initialConditions(m_threadPool) {
+    if (m_minMass < 1 || m_minMass > m_maxMass) {
+        throw SimulationError("The mass range is invalid");
+    }
+
+    m_continuousCollision.setRestitution(m_restitution);
+    m_pairInteraction = settings.pairInteraction;
+
+    if (!settings.obstacleBitmap.empty()) {
+        m_map.loadSolidCells(settings.obstacleBitmap.c_str());
+        m_obstacleField.build(m_map);
+    }
+
+    setUnbounded(settings.unbounded);
+
+    m_gravity = settings.gravity;
+    m_gravitationalConstant = settings.gravitationalConstant;
+    m_fastMultipole.setOrder(settings.multipoleOrder);
+
+    // The random spawn tests every overlap, a large population comes from a generator
+    if (settings.initialCondition) {
+        InitialConditionSettings initialConditionSettings;
+        initialConditionSettings.type = *settings.initialCondition;
+        initialConditionSettings.nbParticles = settings.nbParticles;
+        initialConditionSettings.seed = settings.seed;
+        initialConditionSettings.minMass = m_minMass;
+        initialConditionSettings.maxMass = m_maxMass;
+
+        std::vector<Particle> particles;
+        m_initialConditions.generate(initialConditionSettings, m_map, particles);
+        m_particles.replace(particles);
+        nbParticlesSim = static_cast<int>(m_particles.size());
+    } else {
+        m_particles.reserve(settings.nbParticles);
+        spawnDestroyParticles(settings.nbParticles);
+    }
+    nbParticlesWantedSim = settings.nbParticles;
+
+    if (!settings.sharedStateName.empty()) {
+        m_sharedStateExporter.emplace();
+        m_sharedStateExporter->open(settings.sharedStateName.c_str(), static_cast<std::uint32_t>(settings.nbParticles));
+    }
+
+    if (!settings.framesDirectory.empty()) {
+        if (settings.recordInterval < 1) {
+            throw SimulationError("The record interval must be at least one step");
+        }
+
+        std::filesystem::create_directories(settings.framesDirectory);
+        m_fileWriter.emplace();
+        m_frameRecorder.emplace(recordingWidth, recordingHeight, m_map, m_threadPool.getNbThreads(), *m_fileWriter, settings.framesDirectory);
+        m_recordInterval = settings.recordInterval;
+        m_recordingCamera = settings.camera;
+
+        // By default the whole map height, centered
+        if (m_recordingCamera.w <= 0.0f) {
+            m_recordingCamera.w = m_map.getHeight() * recordingWidth / recordingHeight;
+            m_recordingCamera.h = m_map.getHeight();
+            m_recordingCamera.x = (m_map.getWidth() - m_recordingCamera.w) / 2.0f;
+            m_recordingCamera.y = 0.0f;
+        }
+    }
+}
+
 void Simulation::spawnDestroyParticles(int nbParticlesWanted) {
     if (nbParticlesWanted < 0) {
         throw SimulationError("You can't have a negative number of particles");
@@ -68,38 +172,32 @@ void Simulation::spawnDestroyParticles(int nbParticlesWanted) {
     }
 
     nbParticlesSim = nbParticlesWanted;
+    m_neighbourList.invalidate();
+    m_eventDrivenEngineLoaded = false;
+    m_observables.resetReference();
 }
 
 void Simulation::destroyParticles(int nbParticles) {
+    // The last spawned particles go first, removing the last index moves nothing
     for (int i = 0; i < nbParticles; ++i) {
-        // It calls the object
-        m_particles.pop_back();
+        m_particles.removeAt(m_particles.size() - 1);
     }
 }
 
 void Simulation::spawnParticles(int nbParticles) {
-    std::random_device rd;
-    std::mt19937 gen(rd());
-
-    int minMass{static_cast<int>(0.01f * Particle::sharedParticleMass)};
-    int maxMass{static_cast<int>(0.1f * Particle::sharedParticleMass)};
-    std::uniform_int_distribution<int> distMass(minMass, maxMass);
-
-    float maxSpeed{5000.0f};
-    std::uniform_real_distribution<float> distSpeed(0.0f, maxSpeed);
-    std::uniform_real_distribution<float> distAngle(0.0f, 2.0f * M_PI);
-
-    auto randomCoordinate = [&gen](float min, float max) -> float {
-        std::uniform_real_distribution<float> distCoord(min, max);
-        return distCoord(gen);
-    };
+    const Philox philox{m_seed};
 
     for (int i = 0; i < nbParticles; ++i) {
-        int mass{distMass(gen)};
-        Eigen::Vector2f velocity{distSpeed(gen) * std::cos(distAngle(gen)),
-                                 distSpeed(gen) * std::sin(distAngle(gen))};
+        // Same particle index, same draws: a run is reproduced from its seed
+        ParticleRandom random{philox, m_particles.size()};
+
+        int mass{random.uniformInt(m_minMass, m_maxMass)};
+        const float speed{random.uniform(0.0f, m_maxSpeed)};
+        const float angle{random.uniform(0.0f, 2.0f * static_cast<float>(M_PI))};
+        Eigen::Vector2f velocity{speed * std::cos(angle),
+                                 speed * std::sin(angle)};
 
-        m_particles.emplace_back(mass, velocity);
+        m_particles.insert(mass, velocity);
         Particle& particle{m_particles.back()};
 
         bool collision{false};
@@ -109,8 +207,7 @@ void Simulation::spawnParticles(int nbParticles) {
             // We know the particle's radius
             
             ++counter;
-            constexpr int nbTimesToTry{3};
-            if (counter > nbTimesToTry * nbParticles) {
+            if (counter > maxSpawnAttempts) {
                 throw SimulationError("When initialising there is not enough place to put the particles onto the map");
             }
 
@@ -121,7 +218,7 @@ void Simulation::spawnParticles(int nbParticles) {
                 throw SimulationError("Map is too small so the particle don't fit in it");
             }
 
-            float x{randomCoordinate(minX, maxX)};
+            float x{random.uniform(minX, maxX)};
 
             float minY{particle.getParticle().h};
             float maxY{m_map.getHeight() - particle.getParticle().h};
@@ -130,10 +227,15 @@ void Simulation::spawnParticles(int nbParticles) {
                 throw SimulationError("Map is too small so the particle don't fit in it");
             }
 
-            float y{randomCoordinate(minY, maxY)};
+            float y{random.uniform(minY, maxY)};
 
             particle.setCoordinates(m_map, x, y);
 
+            if (m_obstacleField.hasObstacles() && m_obstacleField.getDistance(particle.getCenter()) < particle.getParticle().w / 2.0f) {
+                collision = true;
+                continue;
+            }
+
             if (m_particles.size() == 1) {
                 collision = false;
                 break;
@@ -156,7 +258,121 @@ void Simulation::spawnParticles(int nbParticles) {
     }
 }
 
+void Simulation::requestParticles() {
+    if (nbParticlesWantedSim == nbParticlesSim || m_jobScheduler.contains(populationJobName)) {
+        return;
+    }
+
+    // One particle per slice, the target is read again at each slice so the slider can keep moving
+    const int nbParticlesStart{nbParticlesSim};
+
+    m_jobScheduler.submit(populationJobName,
+        [this]() -> bool {
+            if (nbParticlesSim != nbParticlesWantedSim) {
+                spawnDestroyParticles(nbParticlesSim + (nbParticlesWantedSim > nbParticlesSim ? 1 : -1));
+            }
+            return nbParticlesSim == nbParticlesWantedSim;
+        },
+        [this, nbParticlesStart]() -> float {
+            const int total{std::max(1, std::abs(nbParticlesWantedSim - nbParticlesStart))};
+            return 1.0f - static_cast<float>(std::abs(nbParticlesWantedSim - nbParticlesSim)) / static_cast<float>(total);
+        });
+}
+
+void Simulation::generateInitialConditions() {
+    m_initialConditionSettings.minMass = m_minMass;
+    m_initialConditionSettings.maxMass = m_maxMass;
+
+    // Generated in chunks under the frame budget into a side buffer, the last slice swaps it in at the frame boundary
+    m_jobScheduler.submit("Generating initial conditions",
+        [this, settings = m_initialConditionSettings, started = false]() mutable -> bool {
+            if (!started) {
+                m_initialConditions.begin(settings, m_map, m_generatedParticles);
+                started = true;
+            }
+
+            if (!m_initialConditions.generateSome(m_map, m_generatedParticles, initialConditionsChunk)) {
+                return false;
+            }
+
+            m_particles.replace(m_generatedParticles);
+
+            // The buffer got the old particles back, a 10M population must not be kept twice
+            std::vector<Particle>().swap(m_generatedParticles);
+
+            nbParticlesSim = static_cast<int>(m_particles.size());
+            nbParticlesWantedSim = nbParticlesSim;
+            m_neighbourList.invalidate();
+            m_eventDrivenEngineLoaded = false;
+            m_observables.resetReference();
+            return true;
+        },
+        [this]() -> float {
+            const std::size_t total{std::max<std::size_t>(1, m_initialConditions.getNbParticles())};
+            return static_cast<float>(m_generatedParticles.size()) / static_cast<float>(total);
+        });
+}
+
+void Simulation::saveCheckpoint() {
+    // The snapshot is taken at the frame boundary, the disk write happens on the writer thread
+    m_jobScheduler.submit("Saving checkpoint", [this]() -> bool {
+        std::filesystem::create_directories(Checkpoint::directory);
+
+        std::vector<std::uint8_t> bytes{m_fileWriter->acquireBuffer()};
+        Checkpoint::encode(m_particles.getParticles(), m_step, bytes);
+
+        char path[64];
+        std::snprintf(path, sizeof(path), "%s/step_%llu.bin", Checkpoint::directory, static_cast<unsigned long long>(m_step));
+        m_lastCheckpoint = path;
+
+        m_lastCheckpointTicket = m_fileWriter->push(path, std::move(bytes));
+        return true;
+    });
+}
+
+void Simulation::loadCheckpoint() {
+    m_jobScheduler.submit("Loading checkpoint", [this]() -> bool {
+        // The file may still be queued or being written
+        const WriteStatus status{m_fileWriter->getStatus(m_lastCheckpointTicket)};
+
+        if (status == WriteStatus::pending) {
+            return false;
+        }
+
+        if (status == WriteStatus::failed) {
+            SDL_Log("Writing the checkpoint %s failed, it isn't loaded", m_lastCheckpoint.c_str());
+            return true;
+        }
+
+        // A missing, truncated or foreign file shouldn't end the run, the current state stays
+        std::vector<Particle> particles;
+        std::uint64_t step{0};
+
+        try {
+            step = Checkpoint::load(m_lastCheckpoint.c_str(), m_map, particles);
+        }
+        catch (const CheckpointError& e) {
+            SDL_Log("%s", e.what());
+            return true;
+        }
+
+        m_step = step;
+        m_particles.replace(particles);
+
+        nbParticlesSim = static_cast<int>(m_particles.size());
+        nbParticlesWantedSim = nbParticlesSim;
+        m_neighbourList.invalidate();
+        m_eventDrivenEngineLoaded = false;
+        m_observables.resetReference();
+        return true;
+    });
+}
+
 Simulation::~Simulation() {
+    if (m_headless) {
+        return;
+    }
+
     ImGui_ImplSDLRenderer3_Shutdown();
     ImGui_ImplSDL3_Shutdown();
     ImGui::DestroyContext();
@@ -180,23 +396,67 @@ void Simulation::run() {
         float deltaTime{static_cast<float>(currentCounter - lastCounter) / static_cast<float>(perfFreq)};  // Convert to seconds
         lastCounter = currentCounter;
 
-        // Start the Dear ImGui frame
-        ImGui_ImplSDLRenderer3_NewFrame();
-        ImGui_ImplSDL3_NewFrame();
-        ImGui::NewFrame();
+        // Frame boundary: the scratch memory of the last frame is rewound and its allocations are counted
+        m_frameArena.reset();
+        AllocationTracker::beginFrame();
+
+        {
+            AllocationTracker::Zone zone{"ImGui"};
+
+            // Start the Dear ImGui frame
+            ImGui_ImplSDLRenderer3_NewFrame();
+            ImGui_ImplSDL3_NewFrame();
+            ImGui::NewFrame();
+
+            myImGuiWindow();
+        }
+
+        {
+            AllocationTracker::Zone zone{"Jobs"};
+
+            // Heavy work asked by the UI runs here, between two physics steps
+            m_jobScheduler.run(m_jobBudgetMs);
+        }
 
-        myImGuiWindow();
+        {
+            AllocationTracker::Zone zone{"Events"};
+            handleEvents(event, running);
 
-        handleEvents(event, running);
+            if (running) {
+                paintObstacles();
+            }
+        }
 
         if (!running) {
             break;
         }
 
-        const bool *keys{SDL_GetKeyboardState(nullptr)};
-        handleMovements(keys, deltaTime);
-        
-        render();
+        {
+            AllocationTracker::Zone zone{"Physics"};
+
+            const bool *keys{SDL_GetKeyboardState(nullptr)};
+            handleMovements(keys, deltaTime);
+
+            if (!m_historyScrubbing) {
+                ++m_step;
+            }
+        }
+
+        {
+            AllocationTracker::Zone zone{"Export"};
+
+            m_sharedStateExporter->publish(m_particles.getParticles(), m_step);
+
+            // Only the particles are copied here, the raster runs on the recorder thread
+            if (m_recordFrames && !m_stateClient.isConnected()) {
+                m_frameRecorder->record(m_particles.getParticles(), m_map, m_viewport.getViewport());
+            }
+        }
+
+        {
+            AllocationTracker::Zone zone{"Render"};
+            render();
+        }
 
         float targetFrameTime {1.0f / targetFPS};
         float frameTime {static_cast<float>(SDL_GetPerformanceCounter() - currentCounter) / perfFreq};
@@ -207,6 +467,83 @@ void Simulation::run() {
     }
 }
 
+void Simulation::runHeadless(int nbSteps, float deltaTime) {
+    for (int i = 0; i < nbSteps; ++i) {
+        stepParticles(deltaTime);
+        ++m_step;
+
+        if (m_sharedStateExporter) {
+            m_sharedStateExporter->publish(m_particles.getParticles(), m_step);
+        }
+
+        if (m_frameRecorder && m_step % m_recordInterval == 0) {
+            m_frameRecorder->record(m_particles.getParticles(), m_map, m_recordingCamera);
+        }
+    }
+}
+
+std::uint64_t Simulation::countSteadyStateAllocations(int nbWarmupSteps, int nbSteps, float deltaTime) {
+    m_history.setMemoryBudget(allocationCheckHistoryBudget);
+
+    auto step = [this, deltaTime]() {
+        m_frameArena.reset();
+        stepParticles(deltaTime);
+        m_history.record(m_particles, m_step + 1, deltaTime);
+        ++m_step;
+    };
+
+    for (int i = 0; i < nbWarmupSteps; ++i) {
+        step();
+    }
+
+    // The counted steps make one frame of the tracker
+    AllocationTracker::beginFrame();
+
+    for (int i = 0; i < nbSteps; ++i) {
+        step();
+    }
+
+    AllocationTracker::beginFrame();
+    return AllocationTracker::getLastFrameAllocations();
+}
+
+void Simulation::runServer(std::uint16_t port) {
+    m_stateServer.open(port, m_map);
+    SDL_Log("Serving %zu particles on port %u", m_particles.size(), static_cast<unsigned>(port));
+
+    const Uint64 perfFreq{SDL_GetPerformanceFrequency()};
+    constexpr float targetFrameTime{1.0f / targetFPS};
+
+    while (true) {
+        const Uint64 currentCounter{SDL_GetPerformanceCounter()};
+
+        stepParticles(targetFrameTime * m_timeScale);
+        ++m_step;
+
+        m_stateServer.publish(m_particles, m_step);
+
+        const float frameTime{static_cast<float>(SDL_GetPerformanceCounter() - currentCounter) / static_cast<float>(perfFreq)};
+
+        if (frameTime < targetFrameTime) {
+            SDL_Delay(static_cast<Uint32>((targetFrameTime - frameTime) * 1.0e3f));
+        }
+    }
+}
+
+void Simulation::connectToServer(const std::string& host, std::uint16_t port) {
+    m_stateClient.connect(host, port);
+
+    // Both ends build the same map, the viewport semantics must match
+    if (m_stateClient.getMapWidth() != m_map.getWidth() || m_stateClient.getMapHeight() != m_map.getHeight()) {
+        m_stateClient.disconnect();
+        throw SimulationError("The server simulates another map size");
+    }
+
+    m_particles.clear();
+    nbParticlesSim = 0;
+    nbParticlesWantedSim = 0;
+}
+
 void Simulation::handleEvents(SDL_Event &event, bool &running) {
     while (SDL_PollEvent(&event)) {
         ImGui_ImplSDL3_ProcessEvent(&event);
@@ -233,18 +570,276 @@ void Simulation::handleMovements(const bool *keys, float deltaTime) {
     SDL_PumpEvents();
     m_viewport.move(m_map, keys, deltaTime);
 
+    // Thin client: the physics runs on the server
+    if (m_stateClient.isConnected()) {
+        const SDL_FRect viewport{m_viewport.getViewport()};
+        m_stateClient.sendCamera(RemoteProtocol::Camera{viewport.x, viewport.y, viewport.w, viewport.h},
+                                 static_cast<std::uint32_t>(m_remoteParticleBudget));
+        m_stateClient.receive();
+        return;
+    }
+
+    if (m_historyScrubbing) {
+        return;
+    }
+
+    const float physicsDeltaTime{deltaTime * m_timeScale};
+    stepParticles(physicsDeltaTime);
+
+    // run() increments m_step right after this step
+    if (m_recordHistory) {
+        m_history.record(m_particles, m_step + 1, physicsDeltaTime);
+    }
+}
+
+void Simulation::stepParticles(float deltaTime) {
+    if (m_reorderInterval > 0 && m_step % m_reorderInterval == 0) {
+        reorderParticles();
+    }
+
+    const Uint64 physicsStart{SDL_GetPerformanceCounter()};
+
+    // The engines feed the observables while they already touch the particles
+    m_observables.beginStep(m_threadPool.getNbThreads(), Eigen::Vector2f{m_map.getWidth() / 2.0f, m_map.getHeight() / 2.0f});
+
+    if (m_physicsEngine == PhysicsEngine::eventDriven) {
+        stepEventDriven(deltaTime);
+    } else {
+        stepTimeStepped(deltaTime);
+    }
+
+    m_observables.endStep();
+
+    // Smoothed so that the gain of a reorder can be read in the ImGui window
+    const float physicsMs{static_cast<float>(SDL_GetPerformanceCounter() - physicsStart) * 1.0e3f / static_cast<float>(SDL_GetPerformanceFrequency())};
+    m_physicsPassMs = 0.95f * m_physicsPassMs + 0.05f * physicsMs;
+}
+
+void Simulation::stepTimeStepped(float deltaTime) {
+    // Fast movers are advanced to their first impact instead of tunneling
+    if (m_sweptCollisions) {
+        m_continuousCollision.advance(m_particles.getParticles(), m_map, m_obstacleField, deltaTime);
+    }
+
+    // Any particle crossing more than half a square per step could jump over a thin wall, the paths are traced
+    const bool obstacles{m_obstacleField.hasObstacles() && !m_map.isUnbounded()};
+
+    // Integration pass, every particle is independent here
+    m_threadPool.parallelFor(m_particles.size(), [&](std::size_t begin, std::size_t end, unsigned) {
+        for (std::size_t i = begin; i < end; ++i) {
+            Particle& particle{m_particles[i]};
+
+            if (!m_sweptCollisions || !m_continuousCollision.isAdvanced(i)) {
+                if (obstacles) {
+                    particle.moveAgainstObstacles(m_obstacleField, deltaTime, m_restitution);
+                } else {
+                    particle.move(deltaTime);
+                }
+                particle.solveWallCollision(m_map);
+            }
+
+            if (obstacles) {
+                particle.solveObstacleCollision(m_obstacleField, m_restitution);
+            }
+        }
+    });
+
+    // Long-range gravity kicks the velocities at the new positions, where the observables sample the energy
+    if (m_gravity) {
+        const Uint64 gravityStart{SDL_GetPerformanceCounter()};
+
+        m_fastMultipole.compute(m_particles.getParticles(), m_gravitationalConstant);
+        m_observables.addPotentialEnergy(m_fastMultipole.getPotentialEnergy());
+
+        const std::vector<Eigen::Vector2f>& accelerations{m_fastMultipole.getAccelerations()};
+        m_threadPool.parallelFor(m_particles.size(), [&](std::size_t begin, std::size_t end, unsigned) {
+            for (std::size_t i = begin; i < end; ++i) {
+                m_particles[i].accelerate(accelerations[i], deltaTime);
+            }
+        });
+
+        m_gravityMs = static_cast<float>(SDL_GetPerformanceCounter() - gravityStart) * 1.0e3f / static_cast<float>(SDL_GetPerformanceFrequency());
+    }
+
+    // Pairs come from the cached Verlet lists, the neighbour search only runs when they got stale
+    m_neighbourList.update(m_particles.getParticles(), m_map, m_pairInteraction);
+
+    const std::vector<std::uint32_t>& offsets{m_neighbourList.getOffsets()};
+    const std::vector<std::uint32_t>& neighbours{m_neighbourList.getNeighbours()};
+
     for (size_t i = 0; i < m_particles.size(); ++i) {
-        Particle& particle{m_particles.at(i)};
+        Particle& particle{m_particles[i]};
+
+        for (std::uint32_t k = offsets[i]; k < offsets[i + 1]; ++k) {
+            Particle& otherParticle{m_particles[neighbours[k]]};
+
+            if (m_pairInteraction == PairInteraction::hardSphere) {
+                particle.checkSolveCollision(otherParticle, m_restitution);
+            } else if (m_pairInteraction == PairInteraction::merging) {
+                if (particle.checkCollisionInit(otherParticle)) {
+                    m_mergingPairs.emplace_back(static_cast<std::uint32_t>(i), neighbours[k]);
+                }
+            } else {
+                m_observables.addPotentialEnergy(particle.applyPairForce(otherParticle, m_pairInteraction, m_pairStrength, deltaTime));
+            }
+        }
+    }
+
+    // The indices of the pairs are only valid until the first removal, so merging waits for the end of the pass
+    mergeParticles();
+
+    // The kinetic energy is sampled once the pair impulses are in, at the positions the potential energy was computed at
+    m_threadPool.parallelFor(m_particles.size(), [&](std::size_t begin, std::size_t end, unsigned threadIndex) {
+        for (std::size_t i = begin; i < end; ++i) {
+            m_observables.accumulate(threadIndex, m_particles[i]);
+        }
+    });
+}
+
+void Simulation::mergeParticles() {
+    if (m_mergingPairs.empty()) {
+        return;
+    }
+
+    // A particle absorbed during this step can't absorb any other one, it's gone
+    m_absorbed.assign(m_particles.size(), 0);
+
+    for (const auto& [i, j] : m_mergingPairs) {
+        if (m_absorbed[i] || m_absorbed[j]) {
+            continue;
+        }
 
-        particle.move(deltaTime);
-        particle.solveWallCollision(m_map);
+        m_particles[i].merge(m_particles[j], m_map);
+        m_absorbed[j] = 1;
+        ++m_nbMerges;
+    }
 
-        for (size_t j = i + 1; j < m_particles.size(); ++j) {
-            Particle& otherParticle{m_particles.at(j)};
+    m_mergingPairs.clear();
 
-            particle.checkSolveCollision(otherParticle);
+    // Descending indices: the last particle moved into a hole by the swap-to-end is never one still to remove
+    for (std::size_t index = m_particles.size(); index-- > 0;) {
+        if (m_absorbed[index]) {
+            m_particles.removeAt(index);
         }
     }
+
+    nbParticlesSim = static_cast<int>(m_particles.size());
+    nbParticlesWantedSim = nbParticlesSim;
+    m_neighbourList.invalidate();
+}
+
+void Simulation::stepEventDriven(float deltaTime) {
+    // The engine keeps its own exact state, it only has to be reloaded when the particles changed from the outside
+    if (!m_eventDrivenEngineLoaded) {
+        m_eventDrivenEngine.load(m_particles.getParticles(), m_map);
+        m_eventDrivenEngineLoaded = true;
+    }
+
+    m_eventDrivenEngine.advance(deltaTime);
+    m_eventDrivenEngine.store(m_particles.getParticles(), m_map, m_observables);
+}
+
+void Simulation::restoreHistory(std::uint64_t step) {
+    m_history.restore(step, m_particles);
+    m_step = step;
+
+    nbParticlesSim = static_cast<int>(m_particles.size());
+    nbParticlesWantedSim = nbParticlesSim;
+    m_neighbourList.invalidate();
+    m_eventDrivenEngineLoaded = false;
+    m_observables.resetReference();
+}
+
+void Simulation::paintObstacles() {
+    // Left button paints solid squares, right button erases them, unless the mouse is over ImGui
+    if (m_paintObstacles && !m_map.isUnbounded() && !ImGui::GetIO().WantCaptureMouse) {
+        float mouseX, mouseY;
+        const SDL_MouseButtonFlags buttons{SDL_GetMouseState(&mouseX, &mouseY)};
+        const bool paint{(buttons & SDL_BUTTON_LMASK) != 0};
+        const bool erase{(buttons & SDL_BUTTON_RMASK) != 0};
+
+        const SDL_FRect viewport{m_viewport.getViewport()};
+        const float scale{viewport.w / screenWidth};
+        const int col{static_cast<int>((viewport.x + mouseX * scale) / m_map.getSquareSize())};
+        const int row{static_cast<int>((viewport.y + mouseY * scale) / m_map.getSquareSize())};
+        const bool inside{col >= 0 && row >= 0 && col < m_map.getNbColumns() && row < m_map.getNbRows()};
+
+        if ((paint || erase) && inside && m_map.isSolid(col, row) != paint) {
+            m_map.setSolid(col, row, paint);
+            m_map.updateTexture(m_renderer, col, row);
+            m_obstaclesChanged = true;
+        }
+    }
+
+    // The distance field follows in slices, painting goes on meanwhile and triggers another rebuild
+    if (m_obstaclesChanged && !m_jobScheduler.contains(obstacleJobName)) {
+        m_obstaclesChanged = false;
+
+        m_jobScheduler.submit(obstacleJobName, [this, started = false]() mutable -> bool {
+            if (!started) {
+                m_obstacleField.startBuild(m_map);
+                started = true;
+                return false;
+            }
+
+            return m_obstacleField.continueBuild(obstacleLinesPerSlice);
+        }, [this]() {return m_obstacleField.getBuildProgress();});
+    }
+}
+
+void Simulation::loadObstacles() {
+    // A wrong path in the text field shouldn't end the run
+    try {
+        m_map.loadSolidCells(m_obstacleBitmap);
+    }
+    catch (const MapError& e) {
+        SDL_Log("%s", e.what());
+        return;
+    }
+
+    m_map.updateTexture(m_renderer);
+    m_obstaclesChanged = true;
+}
+
+void Simulation::setUnbounded(bool unbounded) {
+    m_map.setUnbounded(unbounded);
+
+    // The event-driven engine predicts wall events and keeps a grid over the map
+    if (unbounded && m_physicsEngine == PhysicsEngine::eventDriven) {
+        m_physicsEngine = PhysicsEngine::timeStepped;
+    }
+
+    // Back in the box: the particles that left are put on its sides, the viewport fits in it again
+    if (!unbounded) {
+        for (Particle& particle : m_particles) {
+            const SDL_FRect rect{particle.getParticle()};
+            particle.setCoordinates(m_map, rect.x, rect.y);
+        }
+
+        if (!m_headless) {
+            m_viewport.setSize(m_map, screenWidth, screenHeight);
+        }
+    }
+
+    m_neighbourList.invalidate();
+    m_eventDrivenEngineLoaded = false;
+    m_observables.resetReference();
+}
+
+void Simulation::reorderParticles() {
+    const Uint64 reorderStart{SDL_GetPerformanceCounter()};
+
+    const std::vector<std::uint32_t>& order{m_mortonOrder.computeOrder(m_particles.getParticles(), m_map)};
+
+    // The handles follow their particles
+    m_particles.permute(order);
+
+    // The neighbour lists and the event-driven engine are the only index holders, they are simply rebuilt
+    m_neighbourList.invalidate();
+    m_eventDrivenEngineLoaded = false;
+
+    m_reorderMs = static_cast<float>(SDL_GetPerformanceCounter() - reorderStart) * 1.0e3f / static_cast<float>(SDL_GetPerformanceFrequency());
+    m_physicsPassMsBeforeReorder = m_physicsPassMs;
 }
 
 void Simulation::render() {
@@ -256,18 +851,110 @@ void Simulation::render() {
 
     // Order of rendering matters for layering
 
-    m_map.render(m_renderer, m_viewport.getViewport());
+    const SDL_FRect viewport{m_viewport.getViewport()};
+
+    // The discs are batched in the frame arena, one draw call per discBatchSize discs
+    std::pmr::vector<SDL_Vertex> vertices{m_frameArena.getResource()};
+    std::pmr::vector<int> indices{m_frameArena.getResource()};
+    vertices.reserve(4 * discBatchSize);
+    indices.reserve(6 * discBatchSize);
+
+    for (int disc = 0; disc < static_cast<int>(discBatchSize); ++disc) {
+        for (int corner : {0, 1, 2, 0, 2, 3}) {
+            indices.push_back(4 * disc + corner);
+        }
+    }
+
+    auto appended = [&](bool added) {
+        if (added && vertices.size() == 4 * discBatchSize) {
+            Particle::renderDiscs(m_renderer, vertices, indices);
+            vertices.clear();
+        }
+    };
+
+    if (m_map.isUnbounded()) {
+        // Open space: only the occupied cells are drawn, and only their particles are culled one by one
+        m_spaceGrid.build(m_particles.getParticles(), m_map.getSquareSize() * squaresPerSpaceCell);
+        renderSpaceBackground();
+
+        const float cellSize{m_spaceGrid.getCellSize()};
+        const float margin{m_spaceGrid.getMaxRadius()};
+        const std::vector<std::uint32_t>& cellParticles{m_spaceGrid.getParticles()};
+
+        for (const SparseGrid::Cell& cell : m_spaceGrid.getCells()) {
+            const float x{cell.column * cellSize};
+            const float y{cell.row * cellSize};
+
+            if (x + cellSize + margin < viewport.x || x - margin > viewport.x + viewport.w
+                || y + cellSize + margin < viewport.y || y - margin > viewport.y + viewport.h) {
+                continue;
+            }
+
+            for (std::uint32_t k = cell.begin; k < cell.end; ++k) {
+                appended(m_particles[cellParticles[k]].appendDisc(vertices, viewport, screenWidth));
+            }
+        }
+    } else {
+        m_map.render(m_renderer, viewport);
 
-    for (Particle& particle : m_particles) {
-        particle.render(m_renderer, m_viewport.getViewport(), screenWidth);
+        for (const Particle& particle : m_particles) {
+            appended(particle.appendDisc(vertices, viewport, screenWidth));
+        }
     }
 
+    for (const RemoteProtocol::QuantizedParticle& particle : m_stateClient.getParticles()) {
+        appended(Particle::appendDisc(vertices, m_stateClient.getDisc(particle), viewport, screenWidth));
+    }
+
+    Particle::renderDiscs(m_renderer, vertices, indices);
+
     ImGui::Render();
     ImGui_ImplSDLRenderer3_RenderDrawData(ImGui::GetDrawData(), m_renderer);
 
     SDL_RenderPresent(m_renderer);
 }
 
+void Simulation::renderSpaceBackground() {
+    const SDL_FRect viewport{m_viewport.getViewport()};
+    const float scale{screenWidth / viewport.w};
+    const float cellSize{m_spaceGrid.getCellSize()};
+    const float squareSize{m_map.getSquareSize()};
+
+    // Same chessboard as the map, square by square over the visible occupied cells
+    std::pmr::vector<SDL_FRect> darkSquares{m_frameArena.getResource()};
+    std::pmr::vector<SDL_FRect> lightSquares{m_frameArena.getResource()};
+
+    for (const SparseGrid::Cell& cell : m_spaceGrid.getCells()) {
+        const float x{cell.column * cellSize};
+        const float y{cell.row * cellSize};
+
+        if (x + cellSize < viewport.x || x > viewport.x + viewport.w || y + cellSize < viewport.y || y > viewport.y + viewport.h) {
+            continue;
+        }
+
+        for (int row = 0; row < squaresPerSpaceCell; ++row) {
+            for (int col = 0; col < squaresPerSpaceCell; ++col) {
+                const SDL_FRect square{(x + col * squareSize - viewport.x) * scale, (y + row * squareSize - viewport.y) * scale,
+                                       squareSize * scale, squareSize * scale};
+                const bool isColored{((cell.column * squaresPerSpaceCell + col + cell.row * squaresPerSpaceCell + row) & 1) == 0};
+
+                (isColored ? darkSquares : lightSquares).push_back(square);
+            }
+        }
+    }
+
+    for (const auto& [squares, rgba] : {std::pair{&darkSquares, 50}, std::pair{&lightSquares, 150}}) {
+        if (squares->empty()) {
+            continue;
+        }
+
+        if (!SDL_SetRenderDrawColor(m_renderer, rgba, rgba, rgba, 255)
+            || !SDL_RenderFillRects(m_renderer, squares->data(), static_cast<int>(squares->size()))) {
+            throw SimulationError("Rendering the occupied space failed: ", SDL_GetError());
+        }
+    }
+}
+
 void Simulation::myImGuiWindow() {
     ImGui::SetNextWindowPos(ImVec2(0, 0), ImGuiCond_FirstUseEver);
     ImGui::Begin("Simulation toolbox and information center", nullptr, ImGuiWindowFlags_AlwaysAutoResize);
@@ -276,6 +963,13 @@ void Simulation::myImGuiWindow() {
 
     ImGui::Text("Simulation average %.3f ms/frame (%.1f FPS)", 1000.0f / io.Framerate, io.Framerate);
 
+    // The simulation controls belong to the server
+    if (m_stateClient.isConnected()) {
+        remoteImGui();
+        ImGui::End();
+        return;
+    }
+
     // Nb particles simulation
     if (ImGui::Button("-") && (nbParticlesWantedSim > 0)) {
         --nbParticlesWantedSim;
@@ -289,19 +983,333 @@ void Simulation::myImGuiWindow() {
     ImGui::SameLine();
     ImGui::Text("Particles");
 
-    spawnDestroyParticles(nbParticlesWantedSim);
+    requestParticles();
+
+    // Initial conditions
+    const char* initialConditions[]{"Lattice", "Plummer sphere", "Exponential disk", "Colliding clusters", "Thermal gas"};
+    int initialCondition{static_cast<int>(m_initialConditionSettings.type)};
+    if (ImGui::Combo("Initial conditions", &initialCondition, initialConditions, IM_ARRAYSIZE(initialConditions))) {
+        m_initialConditionSettings.type = static_cast<InitialCondition>(initialCondition);
+    }
+    ImGui::InputInt("Generated particles", &m_initialConditionSettings.nbParticles, 1000, 100000);
+    m_initialConditionSettings.nbParticles = std::clamp(m_initialConditionSettings.nbParticles, 0, maxGeneratedParticles);
+    ImGui::InputScalar("Seed", ImGuiDataType_U64, &m_initialConditionSettings.seed);
+    if (m_initialConditionSettings.type == InitialCondition::thermalGas) {
+        ImGui::SliderFloat("kT (J)", &m_initialConditionSettings.temperature, 1.0e3f, 1.0e9f, "%.3g", ImGuiSliderFlags_Logarithmic);
+    } else {
+        ImGui::SliderFloat("Speed (px/s)", &m_initialConditionSettings.speed, 0.0f, 10000.0f);
+    }
+    if (ImGui::Button("Generate")) {
+        generateInitialConditions();
+    }
+    ImGui::SameLine();
+    ImGui::Text("Spawn seed %llu", static_cast<unsigned long long>(m_seed));
+
+    // Background jobs
+    ImGui::SliderFloat("Job budget (ms/frame)", &m_jobBudgetMs, 0.5f, 16.0f);
+    if (!m_jobScheduler.isIdle()) {
+        const float progress{m_jobScheduler.getCurrentProgress()};
+        ImGui::ProgressBar(progress < 0.0f ? 0.0f : progress, ImVec2(-1.0f, 0.0f), m_jobScheduler.getCurrentName().c_str());
+        ImGui::Text("%zu jobs queued, %.2f ms spent this frame", m_jobScheduler.getNbJobs(), m_jobScheduler.getLastRunMs());
+    }
 
-    ImGui::Text("Total kinetic energy (MJ) : %.3f", getTotalKineticEnergy() / 1e6);
+    if (ImGui::Button("Save checkpoint")) {
+        saveCheckpoint();
+    }
+    if (!m_lastCheckpoint.empty()) {
+        ImGui::SameLine();
+        if (ImGui::Button("Load last checkpoint")) {
+            loadCheckpoint();
+        }
+        ImGui::SameLine();
+        ImGui::Text("%s", m_lastCheckpoint.c_str());
+    }
+
+    observablesImGui();
+    historyImGui();
+
+    // Open space, the obstacles and the event-driven engine only live inside the map
+    bool unbounded{m_map.isUnbounded()};
+    if (ImGui::Checkbox("Unbounded space", &unbounded)) {
+        setUnbounded(unbounded);
+    }
+    if (m_map.isUnbounded()) {
+        ImGui::SameLine();
+        ImGui::Text("%zu occupied cells (%.1f kB)", m_spaceGrid.getCells().size(), m_spaceGrid.getMemoryUsage() / 1.0e3);
+    } else {
+        obstaclesImGui();
+    }
+    allocationsImGui();
+
+    // Live state export for external tools (see examples/sharedStateReader.cpp)
+    if (ImGui::Checkbox("Export state to shared memory", &m_exportSharedState)) {
+        if (m_exportSharedState) {
+            m_sharedStateExporter->open(SharedState::defaultName, static_cast<std::uint32_t>(m_particles.size()));
+        } else {
+            m_sharedStateExporter->close();
+        }
+    }
+    if (m_exportSharedState) {
+        ImGui::SameLine();
+        ImGui::Text("%s (step %llu, room for %u particles)", SharedState::defaultName, static_cast<unsigned long long>(m_step),
+                    m_sharedStateExporter->getCapacity());
+    }
+
+    // Physics engine
+    const char* engines[]{"Time-stepped", "Event-driven (hard discs)"};
+    int engine{static_cast<int>(m_physicsEngine)};
+    if (ImGui::Combo("Physics engine", &engine, engines, IM_ARRAYSIZE(engines))) {
+        m_physicsEngine = static_cast<PhysicsEngine>(engine);
+        m_eventDrivenEngineLoaded = false;
+    }
+    if (m_physicsEngine == PhysicsEngine::eventDriven && m_map.isUnbounded()) {
+        m_physicsEngine = PhysicsEngine::timeStepped;
+    }
+    if (m_physicsEngine == PhysicsEngine::eventDriven) {
+        ImGui::Text("Events: %llu pair, %llu wall, %llu cell crossings, %llu invalidated",
+                    static_cast<unsigned long long>(m_eventDrivenEngine.getNbPairCollisions()),
+                    static_cast<unsigned long long>(m_eventDrivenEngine.getNbWallCollisions()),
+                    static_cast<unsigned long long>(m_eventDrivenEngine.getNbCellCrossings()),
+                    static_cast<unsigned long long>(m_eventDrivenEngine.getNbInvalidEvents()));
+    }
+
+    ImGui::SliderFloat("Simulation speed", &m_timeScale, 0.1f, maxTimeScale, "x%.1f", ImGuiSliderFlags_Logarithmic);
+
+    // Swept collisions, only used by the time-stepped engine
+    if (m_physicsEngine == PhysicsEngine::timeStepped) {
+        ImGui::Checkbox("Swept collisions", &m_sweptCollisions);
+        if (m_sweptCollisions) {
+            ImGui::SameLine();
+            float speedThreshold{m_continuousCollision.getSpeedThreshold()};
+            if (ImGui::SliderFloat("Speed threshold (px/s)", &speedThreshold, 0.0f, 10000.0f)) {
+                m_continuousCollision.setSpeedThreshold(speedThreshold);
+            }
+            ImGui::Text("Swept: %zu fast particles, %zu impacts this step", m_continuousCollision.getNbFastParticles(),
+                        m_continuousCollision.getNbImpacts());
+        }
+    }
+
+    if (m_physicsEngine == PhysicsEngine::timeStepped) {
+        gravityImGui();
+    }
+
+    // Short-range interaction and Verlet lists, only used by the time-stepped engine
+    const char* interactions[]{"Hard spheres", "Soft repulsion", "Lennard-Jones", "Merging"};
+    int interaction{static_cast<int>(m_pairInteraction)};
+    if (ImGui::Combo("Pair interaction", &interaction, interactions, IM_ARRAYSIZE(interactions))) {
+        m_pairInteraction = static_cast<PairInteraction>(interaction);
+        m_observables.resetReference();
+    }
+    if (m_pairInteraction == PairInteraction::hardSphere) {
+        if (ImGui::SliderFloat("Restitution", &m_restitution, 0.0f, 1.0f)) {
+            m_continuousCollision.setRestitution(m_restitution);
+        }
+    } else if (m_pairInteraction == PairInteraction::merging) {
+        ImGui::Text("%llu merges since the start", static_cast<unsigned long long>(m_nbMerges));
+    } else {
+        ImGui::SliderFloat("Strength", &m_pairStrength, 1.0e4f, 1.0e8f, "%.3g", ImGuiSliderFlags_Logarithmic);
+    }
+    float skin{m_neighbourList.getSkin()};
+    if (ImGui::SliderFloat("Verlet skin (px)", &skin, 1.0f, 200.0f)) {
+        m_neighbourList.setSkin(skin);
+    }
+    const std::uint64_t nbUpdates{std::max<std::uint64_t>(1, m_neighbourList.getNbUpdates())};
+    ImGui::Text("Neighbour lists: %zu pairs, rebuilt on %.1f%% of the steps", m_neighbourList.getNeighbours().size(),
+                100.0 * static_cast<double>(m_neighbourList.getNbBuilds()) / static_cast<double>(nbUpdates));
+
+    // Morton reordering, the gain is the physics pass time right before the last reorder minus the current one
+    ImGui::SliderInt("Morton reorder interval (steps)", &m_reorderInterval, 0, maxReorderInterval);
+    if (m_reorderInterval > 0) {
+        const float savedMs{(m_physicsPassMsBeforeReorder - m_physicsPassMs) * m_reorderInterval};
+        ImGui::Text("Reorder %.3f ms | physics %.3f -> %.3f ms/step | saved ~%.3f ms per interval",
+                    m_reorderMs, m_physicsPassMsBeforeReorder, m_physicsPassMs, savedMs);
+    }
+
+    // Offline movie recording, the camera follows the viewport
+    if (ImGui::Checkbox("Record frames", &m_recordFrames) && m_recordFrames) {
+        std::filesystem::create_directories(m_frameRecorder->getDirectory());
+    }
+    ImGui::SameLine();
+    bool densitySplats{m_frameRecorder->getStyle() == OfflineRenderer::Style::densitySplats};
+    if (ImGui::Checkbox("Density splats", &densitySplats)) {
+        m_frameRecorder->setStyle(densitySplats ? OfflineRenderer::Style::densitySplats : OfflineRenderer::Style::discs);
+    }
+    if (m_recordFrames) {
+        ImGui::Text("%d frames (%dx%d) recorded to %s/, %zu pending", m_frameRecorder->getNbRecordedFrames(), recordingWidth, recordingHeight,
+                    m_frameRecorder->getDirectory().c_str(), m_fileWriter->getNbPending());
+    }
 
     ImGui::End();
 }
 
-float Simulation::getTotalKineticEnergy() {
-    float sum{0.0f};
+void Simulation::observablesImGui() {
+    const ObservableSample& sample{m_observables.getSample()};
+
+    ImGui::Text("Energy (MJ): kinetic %.3f, potential %.3f, total %.3f (drift %+.2e)", sample.kineticEnergy / 1e6,
+                sample.potentialEnergy / 1e6, sample.getTotalEnergy() / 1e6, m_observables.getEnergyDrift());
+    ImGui::Text("Momentum (%.3g, %.3g), angular momentum %.3g, center of mass (%.0f, %.0f)", sample.momentum(0), sample.momentum(1),
+                sample.angularMomentum, sample.centerOfMass(0), sample.centerOfMass(1));
+
+    if (!ImGui::CollapsingHeader("Observables plots")) {
+        return;
+    }
+
+    const int offset{m_observables.getHistoryOffset()};
+    const int historySize{static_cast<int>(Observables::historySize)};
+    ImGui::PlotLines("Total energy", m_observables.getTotalEnergyHistory().data(), historySize, offset, nullptr, FLT_MAX, FLT_MAX, ImVec2(0.0f, 60.0f));
+    ImGui::PlotLines("|Momentum|", m_observables.getMomentumHistory().data(), historySize, offset, nullptr, FLT_MAX, FLT_MAX, ImVec2(0.0f, 60.0f));
+    ImGui::PlotLines("Angular momentum", m_observables.getAngularMomentumHistory().data(), historySize, offset, nullptr, FLT_MAX, FLT_MAX, ImVec2(0.0f, 60.0f));
+
+    // Same vertical scale for the histogram and its fit so they can be compared
+    const auto& histogram{m_observables.getHistogram()};
+    const auto& fit{m_observables.getFittedHistogram()};
+    const float scaleMax{std::max(*std::max_element(histogram.begin(), histogram.end()), *std::max_element(fit.begin(), fit.end()))};
+
+    ImGui::PlotHistogram("Speeds", histogram.data(), Observables::nbHistogramBins, 0, nullptr, 0.0f, scaleMax, ImVec2(0.0f, 80.0f));
+    ImGui::PlotLines("Maxwell-Boltzmann fit", fit.data(), Observables::nbHistogramBins, 0, nullptr, 0.0f, scaleMax, ImVec2(0.0f, 80.0f));
+    ImGui::Text("Fitted kT %.3g J, speeds from 0 to %.0f px/s", m_observables.getFittedTemperature(), Observables::histogramMaxSpeed);
+}
+
+void Simulation::remoteImGui() {
+    ImGui::Text("Remote step %llu: %zu of %u visible particles received",
+                static_cast<unsigned long long>(m_stateClient.getStep()), m_stateClient.getParticles().size(), m_stateClient.getNbVisible());
+    ImGui::Text("Last frame %.1f kB, %.1f MB received", m_stateClient.getLastFrameBytes() / 1.0e3, m_stateClient.getNbBytesReceived() / 1.0e6);
+    ImGui::SliderInt("Particle budget", &m_remoteParticleBudget, 100, maxRemoteParticleBudget, "%d", ImGuiSliderFlags_Logarithmic);
+}
+
+void Simulation::historyImGui() {
+    if (ImGui::Checkbox("Record history", &m_recordHistory) && !m_recordHistory) {
+        m_history.clear();
+        m_historyScrubbing = false;
+    }
 
-    for (Particle& particle : m_particles) {
-        sum += particle.getKineticEnergy();
+    if (!m_recordHistory) {
+        return;
     }
 
-    return sum;
+    int budgetMB{static_cast<int>(m_history.getMemoryBudget() >> 20)};
+    if (ImGui::SliderInt("History budget (MB)", &budgetMB, 16, maxHistoryBudgetMB, "%d", ImGuiSliderFlags_Logarithmic)) {
+        m_history.setMemoryBudget(static_cast<std::size_t>(budgetMB) << 20);
+    }
+    int keyframeInterval{m_history.getKeyframeInterval()};
+    if (ImGui::SliderInt("Keyframe interval (steps)", &keyframeInterval, 1, 4096, "%d", ImGuiSliderFlags_Logarithmic)) {
+        m_history.setKeyframeInterval(keyframeInterval);
+    }
+
+    if (m_history.empty()) {
+        return;
+    }
+
+    // Average size of a step against a full copy of the particles
+    const double fullCopyBytes{static_cast<double>(m_particles.size() * HistoryBuffer::keyframeParticleSize)};
+    const double stepBytes{static_cast<double>(m_history.getMemoryUsage()) / static_cast<double>(m_history.getNbSteps())};
+    ImGui::Text("%zu steps, %zu keyframes, %.1f MB (%.1f%% of a full copy per step)", m_history.getNbSteps(), m_history.getNbKeyframes(),
+                m_history.getMemoryUsage() / 1.0e6, fullCopyBytes > 0.0 ? 100.0 * stepBytes / fullCopyBytes : 0.0);
+
+    if (!m_historyScrubbing) {
+        m_scrubStep = m_history.getNewestStep();
+    }
+
+    const std::uint64_t oldestStep{m_history.getOldestStep()};
+    const std::uint64_t newestStep{m_history.getNewestStep()};
+    std::uint64_t scrubStep{m_scrubStep};
+
+    if (ImGui::Button("<") && scrubStep > oldestStep) {
+        --scrubStep;
+    }
+    ImGui::SameLine();
+    ImGui::SliderScalar("##history slider", ImGuiDataType_U64, &scrubStep, &oldestStep, &newestStep);
+    ImGui::SameLine();
+    if (ImGui::Button(">") && scrubStep < newestStep) {
+        ++scrubStep;
+    }
+    ImGui::SameLine();
+    ImGui::Text("Step");
+
+    if (scrubStep != m_scrubStep) {
+        m_historyScrubbing = true;
+        m_scrubStep = scrubStep;
+        restoreHistory(m_scrubStep);
+    }
+
+    // Resuming forgets the steps after the restored one, the run goes on from there
+    if (m_historyScrubbing && ImGui::Button("Resume from this step")) {
+        m_history.truncateAfter(m_scrubStep);
+        m_historyScrubbing = false;
+    }
+}
+
+void Simulation::obstaclesImGui() {
+    ImGui::Checkbox("Paint obstacles (left: solid, right: free)", &m_paintObstacles);
+    ImGui::InputText("##obstacle bitmap", m_obstacleBitmap, sizeof(m_obstacleBitmap));
+    ImGui::SameLine();
+    if (ImGui::Button("Load obstacles")) {
+        loadObstacles();
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Clear obstacles")) {
+        m_map.clearSolidCells();
+        m_map.updateTexture(m_renderer);
+        m_obstaclesChanged = true;
+    }
+}
+
+void Simulation::gravityImGui() {
+    if (ImGui::Checkbox("Gravity (fast multipole)", &m_gravity)) {
+        m_observables.resetReference();
+        m_multipoleError = MultipoleError{};
+    }
+    if (!m_gravity) {
+        return;
+    }
+
+    if (ImGui::SliderFloat("G", &m_gravitationalConstant, 1.0f, 1.0e6f, "%.3g", ImGuiSliderFlags_Logarithmic)) {
+        m_observables.resetReference();
+    }
+    int order{m_fastMultipole.getOrder()};
+    if (ImGui::SliderInt("Expansion order", &order, 2, FastMultipole::maxOrder)) {
+        m_fastMultipole.setOrder(order);
+    }
+    float softening{m_fastMultipole.getSoftening()};
+    if (ImGui::SliderFloat("Softening (px)", &softening, 0.0f, 100.0f)) {
+        m_fastMultipole.setSoftening(softening);
+        m_observables.resetReference();
+    }
+    ImGui::Text("Gravity %.3f ms/step: %zu boxes, %zu M2L, %zu P2P", m_gravityMs, m_fastMultipole.getNbNodes(),
+                m_fastMultipole.getNbM2L(), m_fastMultipole.getNbP2P());
+
+    // Exact sum over all the particles for a few of them, the particles moved since the last step
+    if (ImGui::Button("Check accuracy")) {
+        m_fastMultipole.compute(m_particles.getParticles(), m_gravitationalConstant);
+        m_multipoleError = m_fastMultipole.measureError(m_particles.getParticles(), multipoleErrorSamples);
+    }
+    if (m_multipoleError.nbSamples > 0) {
+        ImGui::SameLine();
+        ImGui::Text("Relative error on %zu particles: max %.2e, rms %.2e", m_multipoleError.nbSamples,
+                    m_multipoleError.maxRelativeError, m_multipoleError.rmsRelativeError);
+    }
+}
+
+void Simulation::allocationsImGui() {
+    if (!ImGui::CollapsingHeader("Heap allocations")) {
+        return;
+    }
+
+    ImGui::Text("Frame arena %.1f kB, grown %zu times", m_frameArena.getCapacity() / 1.0e3, m_frameArena.getNbGrowths());
+
+    if (!AllocationTracker::enabled) {
+        ImGui::Text("Not counted, build with GRAVITY_TRACK_ALLOCATIONS");
+        return;
+    }
+
+    // Once warmed up a frame shouldn't touch the heap at all
+    const std::uint64_t nbAllocations{AllocationTracker::getLastFrameAllocations()};
+    const ImVec4 color{nbAllocations > 0 ? ImVec4(1.0f, 0.3f, 0.3f, 1.0f) : ImVec4(0.3f, 1.0f, 0.3f, 1.0f)};
+    ImGui::TextColored(color, "%llu allocations last frame (%llu in total)", static_cast<unsigned long long>(nbAllocations),
+                       static_cast<unsigned long long>(AllocationTracker::getTotalAllocations()));
+
+    for (std::size_t i = 0; i < AllocationTracker::getNbZones(); ++i) {
+        const AllocationTracker::ZoneCount zone{AllocationTracker::getZone(i)};
+        ImGui::BulletText("%s: %llu", zone.name, static_cast<unsigned long long>(zone.lastFrame));
+    }
 }
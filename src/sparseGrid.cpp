@@ -0,0 +1,129 @@
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <vector>
+#include "Eigen/Dense"
+
+#include "sparseGrid.h"
+#include "particle.h"
+
+void SparseGrid::build(const std::vector<Particle>& particles, float cellSize) {
+    const std::size_t nbParticles{particles.size()};
+
+    m_cellSize = cellSize;
+    m_maxRadius = 0.0f;
+
+    // Sized for the cells of the previous build, the particles moved a step at most
+    const std::size_t nbSlots{std::bit_ceil(std::max(minNbSlots, 2 * m_cells.size()))};
+
+    if (m_table.size() < nbSlots || m_table.size() > 4 * nbSlots) {
+        m_cells.clear();
+
+        // Most of the cells were freed, their memory goes too
+        if (m_table.size() > 4 * nbSlots) {
+            m_cells.shrink_to_fit();
+        }
+
+        resizeTable(nbSlots);
+    } else {
+        m_cells.clear();
+        std::fill(m_table.begin(), m_table.end(), emptySlot);
+    }
+
+    // Count the particles of each cell, cells are created on their first particle
+    m_particleCells.resize(nbParticles);
+
+    for (std::size_t i = 0; i < nbParticles; ++i) {
+        const Eigen::Vector2f center{particles[i].getCenter()};
+        const std::uint32_t cell{findOrInsert(getColumn(center(0)), getRow(center(1)))};
+
+        ++m_cells[cell].end;
+        m_particleCells[i] = cell;
+        m_maxRadius = std::max(m_maxRadius, particles[i].getParticle().w / 2.0f);
+    }
+
+    std::uint32_t offset{0};
+
+    for (Cell& cell : m_cells) {
+        const std::uint32_t nbCellParticles{cell.end};
+        cell.begin = offset;
+        cell.end = offset;
+        offset += nbCellParticles;
+    }
+
+    // The scatter moves each end back where it belongs
+    m_particles.resize(nbParticles);
+
+    for (std::size_t i = 0; i < nbParticles; ++i) {
+        m_particles[m_cells[m_particleCells[i]].end++] = static_cast<std::uint32_t>(i);
+    }
+}
+
+const SparseGrid::Cell* SparseGrid::findCell(int column, int row) const {
+    if (m_table.empty()) {
+        return nullptr;
+    }
+
+    for (std::size_t slot = getSlot(column, row); m_table[slot] != emptySlot; slot = (slot + 1) & m_tableMask) {
+        const Cell& cell{m_cells[m_table[slot]]};
+
+        if (cell.column == column && cell.row == row) {
+            return &cell;
+        }
+    }
+
+    return nullptr;
+}
+
+int SparseGrid::getCoordinate(float position) const {
+    // Far enough for any float position at a sensible cell size, and no overflow on the neighbours
+    constexpr float limit{1 << 30};
+    return static_cast<int>(std::clamp(std::floor(position / m_cellSize), -limit, limit));
+}
+
+std::size_t SparseGrid::getSlot(int column, int row) const {
+    const std::uint64_t key{(static_cast<std::uint64_t>(static_cast<std::uint32_t>(column)) << 32) | static_cast<std::uint32_t>(row)};
+    return static_cast<std::size_t>((key * 0x9E3779B97F4A7C15ull) >> 32) & m_tableMask;
+}
+
+std::uint32_t SparseGrid::findOrInsert(int column, int row) {
+    std::size_t slot{getSlot(column, row)};
+
+    for (; m_table[slot] != emptySlot; slot = (slot + 1) & m_tableMask) {
+        const Cell& cell{m_cells[m_table[slot]]};
+
+        if (cell.column == column && cell.row == row) {
+            return m_table[slot];
+        }
+    }
+
+    // At most half full so the probes stay short
+    if (2 * (m_cells.size() + 1) > m_table.size()) {
+        resizeTable(2 * m_table.size());
+        slot = getSlot(column, row);
+
+        while (m_table[slot] != emptySlot) {
+            slot = (slot + 1) & m_tableMask;
+        }
+    }
+
+    const std::uint32_t index{static_cast<std::uint32_t>(m_cells.size())};
+    m_cells.push_back(Cell{column, row, 0, 0});
+    m_table[slot] = index;
+    return index;
+}
+
+void SparseGrid::resizeTable(std::size_t nbSlots) {
+    std::vector<std::uint32_t>(nbSlots, emptySlot).swap(m_table);
+    m_tableMask = nbSlots - 1;
+
+    for (std::uint32_t index = 0; index < m_cells.size(); ++index) {
+        std::size_t slot{getSlot(m_cells[index].column, m_cells[index].row)};
+
+        while (m_table[slot] != emptySlot) {
+            slot = (slot + 1) & m_tableMask;
+        }
+
+        m_table[slot] = index;
+    }
+}
@@ -0,0 +1,213 @@
+#include <SDL3/SDL.h>
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "stateClient.h"
+#include "remoteErrors.h"
+#include "remoteProtocol.h"
+
+namespace {
+    template <typename T>
+    T read(const std::uint8_t*& data) {
+        T value;
+        std::memcpy(&value, data, sizeof(T));
+        data += sizeof(T);
+        return value;
+    }
+
+    /// Size of the fixed part of a frame payload: step, camera, nbVisible and nbSent
+    constexpr std::size_t frameHeaderSize{sizeof(std::uint64_t) + sizeof(RemoteProtocol::Camera) + 2 * sizeof(std::uint32_t)};
+
+    constexpr std::size_t helloSize{RemoteProtocol::messageHeaderSize + sizeof(std::uint32_t) + 2 * sizeof(float)};
+}
+
+void StateClient::connect(const std::string& host, std::uint16_t port) {
+    disconnect();
+
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+
+    addrinfo* addresses{nullptr};
+    const std::string service{std::to_string(port)};
+
+    if (const int error{getaddrinfo(host.c_str(), service.c_str(), &hints, &addresses)}; error != 0) {
+        throw RemoteError("Resolving the server address failed: ", gai_strerror(error));
+    }
+
+    for (addrinfo* address = addresses; address && m_socket == -1; address = address->ai_next) {
+        m_socket = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+
+        if (m_socket != -1 && ::connect(m_socket, address->ai_addr, address->ai_addrlen) == -1) {
+            ::close(m_socket);
+            m_socket = -1;
+        }
+    }
+
+    freeaddrinfo(addresses);
+
+    if (m_socket == -1) {
+        throw RemoteError("Connecting to the server failed: ", std::strerror(errno));
+    }
+
+    std::uint8_t hello[helloSize];
+
+    if (recv(m_socket, hello, sizeof(hello), MSG_WAITALL) != static_cast<ssize_t>(sizeof(hello))) {
+        disconnect();
+        throw RemoteError("The server did not say hello");
+    }
+
+    const std::uint8_t* data{hello};
+    const std::uint32_t payloadSize{read<std::uint32_t>(data)};
+    const std::uint8_t type{read<std::uint8_t>(data)};
+    const std::uint32_t version{read<std::uint32_t>(data)};
+
+    if (type != RemoteProtocol::hello || payloadSize != helloSize - RemoteProtocol::messageHeaderSize || version != RemoteProtocol::protocolVersion) {
+        disconnect();
+        throw RemoteError("The server speaks another protocol version");
+    }
+
+    m_mapWidth = read<float>(data);
+    m_mapHeight = read<float>(data);
+
+    const int enable{1};
+    setsockopt(m_socket, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+    fcntl(m_socket, F_SETFL, fcntl(m_socket, F_GETFL) | O_NONBLOCK);
+}
+
+void StateClient::disconnect() {
+    if (m_socket != -1) {
+        ::close(m_socket);
+        m_socket = -1;
+    }
+
+    m_input.clear();
+    m_output.clear();
+    m_particles.clear();
+    m_hasCamera = false;
+}
+
+void StateClient::sendCamera(const RemoteProtocol::Camera& camera, std::uint32_t particleBudget) {
+    if (m_hasCamera && camera == m_camera && particleBudget == m_particleBudget) {
+        return;
+    }
+
+    m_hasCamera = true;
+    m_camera = camera;
+    m_particleBudget = particleBudget;
+
+    RemoteProtocol::append(m_output, static_cast<std::uint32_t>(sizeof(RemoteProtocol::Camera) + sizeof(std::uint32_t)));
+    RemoteProtocol::append(m_output, RemoteProtocol::camera);
+    RemoteProtocol::append(m_output, camera);
+    RemoteProtocol::append(m_output, particleBudget);
+
+    flush();
+}
+
+bool StateClient::receive() {
+    flush();
+
+    std::uint8_t buffer[65536];
+
+    while (true) {
+        const ssize_t received{recv(m_socket, buffer, sizeof(buffer), 0)};
+
+        if (received == 0) {
+            throw RemoteError("The server closed the connection");
+        }
+
+        if (received == -1) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            }
+            throw RemoteError("Receiving from the server failed: ", std::strerror(errno));
+        }
+
+        m_input.insert(m_input.end(), buffer, buffer + received);
+        m_nbBytesReceived += static_cast<std::uint64_t>(received);
+    }
+
+    // Every frame is decoded, each one is the delta base of the next
+    bool newFrame{false};
+    std::size_t offset{0};
+
+    while (m_input.size() - offset >= RemoteProtocol::messageHeaderSize) {
+        const std::uint8_t* data{m_input.data() + offset};
+        const std::uint32_t payloadSize{read<std::uint32_t>(data)};
+        const std::uint8_t type{read<std::uint8_t>(data)};
+
+        if (payloadSize > RemoteProtocol::maxMessageSize || type != RemoteProtocol::frame) {
+            throw RemoteError("The server sent a corrupted message");
+        }
+
+        if (m_input.size() - offset < RemoteProtocol::messageHeaderSize + payloadSize) {
+            break;
+        }
+
+        readFrame(data, payloadSize);
+        m_lastFrameBytes = RemoteProtocol::messageHeaderSize + payloadSize;
+        newFrame = true;
+
+        offset += RemoteProtocol::messageHeaderSize + payloadSize;
+    }
+
+    m_input.erase(m_input.begin(), m_input.begin() + static_cast<std::ptrdiff_t>(offset));
+    return newFrame;
+}
+
+SDL_FRect StateClient::getDisc(const RemoteProtocol::QuantizedParticle& particle) const {
+    const RemoteProtocol::Grid grid{m_frameCamera};
+    const float diameter{particle.diameter * grid.step};
+
+    return SDL_FRect{grid.originX + particle.x * grid.step - diameter / 2.0f,
+                     grid.originY + particle.y * grid.step - diameter / 2.0f,
+                     diameter,
+                     diameter};
+}
+
+void StateClient::flush() {
+    std::size_t offset{0};
+
+    while (offset < m_output.size()) {
+        const ssize_t sent{send(m_socket, m_output.data() + offset, m_output.size() - offset, MSG_NOSIGNAL)};
+
+        if (sent == -1) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            }
+            throw RemoteError("Sending to the server failed: ", std::strerror(errno));
+        }
+
+        offset += static_cast<std::size_t>(sent);
+    }
+
+    m_output.erase(m_output.begin(), m_output.begin() + static_cast<std::ptrdiff_t>(offset));
+}
+
+void StateClient::readFrame(const std::uint8_t* payload, std::size_t size) {
+    if (size < frameHeaderSize) {
+        throw RemoteError("The server sent a truncated frame");
+    }
+
+    const std::uint8_t* data{payload};
+    m_step = read<std::uint64_t>(data);
+    m_frameCamera = read<RemoteProtocol::Camera>(data);
+    m_nbVisible = read<std::uint32_t>(data);
+    const std::uint32_t nbSent{read<std::uint32_t>(data)};
+
+    // A record is at least 4 bytes, this bounds the memory a corrupted count could ask for
+    if (nbSent > (size - frameHeaderSize) / 4 || !RemoteProtocol::decodeParticles(data, size - frameHeaderSize, nbSent, m_particles, m_decodedParticles)) {
+        throw RemoteError("The server sent a corrupted frame");
+    }
+
+    m_particles.swap(m_decodedParticles);
+}
@@ -0,0 +1,253 @@
+#include <SDL3/SDL.h>
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "stateServer.h"
+#include "remoteErrors.h"
+#include "remoteProtocol.h"
+#include "map.h"
+#include "particle.h"
+#include "particleStore.h"
+
+namespace {
+    /// Start a message, its size is written by endMessage once the payload is appended
+    std::size_t beginMessage(std::vector<std::uint8_t>& bytes, RemoteProtocol::MessageType type) {
+        const std::size_t start{bytes.size()};
+        RemoteProtocol::append(bytes, std::uint32_t{0});
+        RemoteProtocol::append(bytes, type);
+        return start;
+    }
+
+    void endMessage(std::vector<std::uint8_t>& bytes, std::size_t start) {
+        const std::uint32_t payloadSize{static_cast<std::uint32_t>(bytes.size() - start - RemoteProtocol::messageHeaderSize)};
+        std::memcpy(bytes.data() + start, &payloadSize, sizeof(payloadSize));
+    }
+
+    std::uint16_t quantize(float value) {
+        return static_cast<std::uint16_t>(std::clamp(std::lround(value), 0l, 65535l));
+    }
+}
+
+void StateServer::open(std::uint16_t port, const Map& map) {
+    close();
+
+    m_listenSocket = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+
+    if (m_listenSocket == -1) {
+        throw RemoteError("Creating the server socket failed: ", std::strerror(errno));
+    }
+
+    const int enable{1};
+    setsockopt(m_listenSocket, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons(port);
+
+    if (bind(m_listenSocket, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == -1 || listen(m_listenSocket, 8) == -1) {
+        const int error{errno};
+        close();
+        throw RemoteError("Listening on the server port failed: ", std::strerror(error));
+    }
+
+    m_mapWidth = map.getWidth();
+    m_mapHeight = map.getHeight();
+}
+
+void StateServer::close() {
+    for (Client& client : m_clients) {
+        ::close(client.socket);
+    }
+    m_clients.clear();
+
+    if (m_listenSocket != -1) {
+        ::close(m_listenSocket);
+        m_listenSocket = -1;
+    }
+}
+
+void StateServer::publish(const ParticleStore& particles, std::uint64_t step) {
+    if (!isOpen()) {
+        return;
+    }
+
+    acceptClients();
+
+    m_lastFrameBytes = 0;
+
+    for (std::size_t i = 0; i < m_clients.size();) {
+        Client& client{m_clients[i]};
+        bool connected{receive(client) && flush(client)};
+
+        // Nothing new is encoded while the previous frame is still waiting for the socket
+        if (connected && client.hasCamera && client.output.empty()) {
+            encodeFrame(client, particles, step);
+            m_lastFrameBytes += client.output.size();
+            connected = flush(client);
+        }
+
+        if (connected) {
+            ++i;
+        } else {
+            SDL_Log("Remote viewer disconnected");
+            ::close(client.socket);
+            m_clients.erase(m_clients.begin() + static_cast<std::ptrdiff_t>(i));
+        }
+    }
+}
+
+void StateServer::acceptClients() {
+    while (true) {
+        const int clientSocket{accept4(m_listenSocket, nullptr, nullptr, SOCK_NONBLOCK)};
+
+        if (clientSocket == -1) {
+            return;
+        }
+
+        // Frames are small and latency matters more than packet count
+        const int enable{1};
+        setsockopt(clientSocket, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+
+        Client& client{m_clients.emplace_back()};
+        client.socket = clientSocket;
+
+        const std::size_t start{beginMessage(client.output, RemoteProtocol::hello)};
+        RemoteProtocol::append(client.output, RemoteProtocol::protocolVersion);
+        RemoteProtocol::append(client.output, m_mapWidth);
+        RemoteProtocol::append(client.output, m_mapHeight);
+        endMessage(client.output, start);
+
+        SDL_Log("Remote viewer connected");
+    }
+}
+
+bool StateServer::receive(Client& client) {
+    std::uint8_t buffer[4096];
+
+    while (true) {
+        const ssize_t received{recv(client.socket, buffer, sizeof(buffer), 0)};
+
+        if (received == 0) {
+            return false;
+        }
+
+        if (received == -1) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            }
+            return false;
+        }
+
+        client.input.insert(client.input.end(), buffer, buffer + received);
+    }
+
+    // Complete messages only, a partial one waits for the next step
+    std::size_t offset{0};
+
+    while (client.input.size() - offset >= RemoteProtocol::messageHeaderSize) {
+        std::uint32_t payloadSize;
+        std::memcpy(&payloadSize, client.input.data() + offset, sizeof(payloadSize));
+        const std::uint8_t type{client.input[offset + sizeof(payloadSize)]};
+
+        if (payloadSize > RemoteProtocol::maxMessageSize) {
+            return false;
+        }
+
+        if (client.input.size() - offset < RemoteProtocol::messageHeaderSize + payloadSize) {
+            break;
+        }
+
+        const std::uint8_t* payload{client.input.data() + offset + RemoteProtocol::messageHeaderSize};
+
+        if (type != RemoteProtocol::camera || payloadSize != sizeof(RemoteProtocol::Camera) + sizeof(std::uint32_t)) {
+            return false;
+        }
+
+        std::memcpy(&client.camera, payload, sizeof(RemoteProtocol::Camera));
+        std::memcpy(&client.particleBudget, payload + sizeof(RemoteProtocol::Camera), sizeof(std::uint32_t));
+        client.hasCamera = client.camera.w > 0.0f && client.camera.h > 0.0f;
+
+        offset += RemoteProtocol::messageHeaderSize + payloadSize;
+    }
+
+    client.input.erase(client.input.begin(), client.input.begin() + static_cast<std::ptrdiff_t>(offset));
+    return true;
+}
+
+bool StateServer::flush(Client& client) {
+    while (client.outputOffset < client.output.size()) {
+        const ssize_t sent{send(client.socket, client.output.data() + client.outputOffset,
+                                client.output.size() - client.outputOffset, MSG_NOSIGNAL)};
+
+        if (sent == -1) {
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+
+        client.outputOffset += static_cast<std::size_t>(sent);
+        m_nbBytesSent += static_cast<std::uint64_t>(sent);
+    }
+
+    client.output.clear();
+    client.outputOffset = 0;
+    return true;
+}
+
+void StateServer::encodeFrame(Client& client, const ParticleStore& particles, std::uint64_t step) {
+    const RemoteProtocol::Camera& camera{client.camera};
+    const RemoteProtocol::Grid grid{camera};
+
+    // Viewport culling, same test as Particle::appendDisc
+    m_visible.clear();
+
+    for (std::size_t i = 0; i < particles.size(); ++i) {
+        const SDL_FRect rect{particles[i].getParticle()};
+
+        if (rect.x + rect.w < camera.x || rect.x > camera.x + camera.w || rect.y + rect.h < camera.y || rect.y > camera.y + camera.h) {
+            continue;
+        }
+
+        // Only a disc bigger than the camera can touch it with its center off the grid, it is not sent
+        const float x{(rect.x + rect.w / 2.0f - grid.originX) / grid.step};
+        const float y{(rect.y + rect.h / 2.0f - grid.originY) / grid.step};
+
+        if (x < 0.0f || x > 65535.0f || y < 0.0f || y > 65535.0f) {
+            continue;
+        }
+
+        m_visible.push_back(RemoteProtocol::QuantizedParticle{particles.getHandle(i).getId(), quantize(x), quantize(y), quantize(rect.w / grid.step)});
+    }
+
+    // Level of detail: a fixed pseudo-random subset of the ids, so consecutive frames keep the same particles
+    const std::uint32_t nbVisible{static_cast<std::uint32_t>(m_visible.size())};
+
+    if (nbVisible > client.particleBudget) {
+        const double keepFraction{static_cast<double>(client.particleBudget) / static_cast<double>(nbVisible)};
+
+        m_visible.erase(std::remove_if(m_visible.begin(), m_visible.end(), [keepFraction](const RemoteProtocol::QuantizedParticle& particle) {
+            return !RemoteProtocol::isKept(particle.id, keepFraction);
+        }), m_visible.end());
+    }
+
+    std::sort(m_visible.begin(), m_visible.end(), [](const RemoteProtocol::QuantizedParticle& a, const RemoteProtocol::QuantizedParticle& b) {
+        return a.id < b.id;
+    });
+
+    const std::size_t start{beginMessage(client.output, RemoteProtocol::frame)};
+    RemoteProtocol::append(client.output, step);
+    RemoteProtocol::append(client.output, camera);
+    RemoteProtocol::append(client.output, nbVisible);
+    RemoteProtocol::append(client.output, static_cast<std::uint32_t>(m_visible.size()));
+    RemoteProtocol::encodeParticles(client.base, m_visible, client.output);
+    endMessage(client.output, start);
+
+    client.base.swap(m_visible);
+}
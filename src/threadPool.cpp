@@ -0,0 +1,114 @@
+#include <algorithm>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+#include "threadPool.h"
+
+ThreadPool::ThreadPool(unsigned nbThreads) {
+    if (nbThreads == 0) {
+        nbThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    m_workers.reserve(nbThreads - 1);
+
+    // Thread 0 is the caller of parallelFor
+    for (unsigned i = 1; i < nbThreads; ++i) {
+        m_workers.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard lock(m_mutex);
+        m_stopping = true;
+    }
+    m_wakeWorkers.notify_all();
+
+    for (std::thread& worker : m_workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::dispatch(std::size_t count, void* context, Invoker invoker) {
+    if (count == 0) {
+        return;
+    }
+
+    if (m_workers.empty()) {
+        invoker(context, 0, count, 0);
+        return;
+    }
+
+    {
+        std::lock_guard lock(m_mutex);
+        m_context = context;
+        m_invoker = invoker;
+        m_count = count;
+        m_remainingChunks = static_cast<unsigned>(m_workers.size());
+        m_exception = nullptr;
+        ++m_generation;
+    }
+    m_wakeWorkers.notify_all();
+
+    runChunk(0);
+
+    std::unique_lock lock(m_mutex);
+    m_chunksDone.wait(lock, [this] {return m_remainingChunks == 0;});
+
+    m_context = nullptr;
+    m_invoker = nullptr;
+
+    if (m_exception) {
+        std::rethrow_exception(m_exception);
+    }
+}
+
+void ThreadPool::runChunk(unsigned threadIndex) {
+    const std::size_t nbThreads{getNbThreads()};
+    const std::size_t begin{m_count * threadIndex / nbThreads};
+    const std::size_t end{m_count * (threadIndex + 1) / nbThreads};
+
+    if (begin == end) {
+        return;
+    }
+
+    try {
+        m_invoker(m_context, begin, end, threadIndex);
+    }
+    catch (...) {
+        std::lock_guard lock(m_mutex);
+        if (!m_exception) {
+            m_exception = std::current_exception();
+        }
+    }
+}
+
+void ThreadPool::workerLoop(unsigned threadIndex) {
+    std::size_t seenGeneration{0};
+
+    while (true) {
+        {
+            std::unique_lock lock(m_mutex);
+            m_wakeWorkers.wait(lock, [&] {return m_stopping || m_generation != seenGeneration;});
+
+            if (m_stopping) {
+                return;
+            }
+
+            seenGeneration = m_generation;
+        }
+
+        runChunk(threadIndex);
+
+        bool lastChunk{false};
+        {
+            std::lock_guard lock(m_mutex);
+            lastChunk = (--m_remainingChunks == 0);
+        }
+
+        if (lastChunk) {
+            m_chunksDone.notify_one();
+        }
+    }
+}
@@ -28,10 +28,10 @@ void Viewport::zoom(const Map &map, const float changex, const float changey) {
     const float mapWidth = map.getWidth();
     const float mapHeight = map.getHeight();
 
-    // 500 is arbitrary and represents min height
+    // 500 is arbitrary and represents min height, an unbounded map has no max
     bool lessMinHeight{(m_viewport.h + changey < 500.0f)};
-    bool moreMaxHeight{(m_viewport.h + changey > mapHeight)};
-    bool moreMaxWidth{(m_viewport.w + changex > mapWidth)};
+    bool moreMaxHeight{!map.isUnbounded() && (m_viewport.h + changey > mapHeight)};
+    bool moreMaxWidth{!map.isUnbounded() && (m_viewport.w + changex > mapWidth)};
 
     if (lessMinHeight || moreMaxHeight || moreMaxWidth) {
         return;
@@ -43,6 +43,10 @@ void Viewport::zoom(const Map &map, const float changex, const float changey) {
     m_viewport.x -= changex / 2.0f;
     m_viewport.y -= changey / 2.0f;
 
+    if (map.isUnbounded()) {
+        return;
+    }
+
     m_viewport.x = std::clamp(m_viewport.x, 0.0f, mapWidth - m_viewport.w);
     m_viewport.y = std::clamp(m_viewport.y, 0.0f, mapHeight - m_viewport.h);
 }
@@ -68,6 +72,10 @@ void Viewport::move(const Map &map, const bool *keys, const float deltaTime) {
         }
     }
 
+    if (map.isUnbounded()) {
+        return;
+    }
+
     m_viewport.x = std::clamp(m_viewport.x, 0.0f, map.getWidth() - m_viewport.w);
     m_viewport.y = std::clamp(m_viewport.y, 0.0f, map.getHeight() - m_viewport.h);
 }